@@ -20,6 +20,9 @@
 #include <algorithm>
 #include <limits>
 #include <random>
+#include <list>
+
+#include "../data_structures/message_view.hpp"
 
 struct sensor_data {
     char sensor_name[17];
@@ -43,7 +46,7 @@ class Arbiter {
 private:
 
     //Create update line for temperature value
-    void update_temperature(float temperature) {
+    void update_temperature(std::list<lcd_update_line>& lines, float temperature) {
 
         lcd_update_line update_line;
 
@@ -55,11 +58,11 @@ private:
         } else {
             sprintf(update_line.characters, "%.2f C", temperature);
         }
-        state.output.lines.push_front(update_line);
+        lines.push_front(update_line);
     }
 
     //Create update line for humidity value
-    void update_humidity(float humidity) {
+    void update_humidity(std::list<lcd_update_line>& lines, float humidity) {
 
         lcd_update_line update_line;
 
@@ -71,23 +74,23 @@ private:
         } else {
             sprintf(update_line.characters, "%.2f %%", humidity);
         }
-        state.output.lines.push_front(update_line);
+        lines.push_front(update_line);
     }
 
     //Create update line for static text
-    void populate_static_lines(void) {
+    void populate_static_lines(std::list<lcd_update_line>& lines) {
 
         lcd_update_line update_line;
 
         update_line.line_index = 1;
         update_line.alignment = CENTER_MODE;
         sprintf(update_line.characters, "---Temperature---");
-        state.output.lines.push_front(update_line);
+        lines.push_front(update_line);
 
         update_line.line_index = 5;
         update_line.alignment = CENTER_MODE;
         sprintf(update_line.characters, "----Humidity----");
-        state.output.lines.push_front(update_line);
+        lines.push_front(update_line);
     }
 
     /*
@@ -112,7 +115,7 @@ private:
     }
 
     //Create update line for title of sensor (Given by switch model)
-    void update_sensor_name(const char *sensor_name) {
+    void update_sensor_name(std::list<lcd_update_line>& lines, const char *sensor_name) {
 
         lcd_update_line update_line;
 
@@ -120,7 +123,7 @@ private:
         update_line.alignment = CENTER_MODE;
         sprintf(update_line.characters, "%s", sensor_name);
 
-        state.output.lines.push_front(update_line);
+        lines.push_front(update_line);
     }
 
 
@@ -134,7 +137,7 @@ public:
     // state definition
     struct state_type{
         bool propagating;
-        lcd_update output;
+        lcd_update output{}; // logged before the first sample arrives
     };
     state_type state;
 
@@ -150,21 +153,24 @@ public:
     // external transition
     void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
 
-        const std::vector<struct sensor_data> data = get_messages<typename defs::sensor_in>(mbs);
+        const message_view<sensor_data> data = messages_in<typename defs::sensor_in>(mbs);
 
         if (data.size() == 1) {
 
-            state.output.lines.clear();
+            std::list<lcd_update_line> lines;
             state.output.text_colour = LCD_COLOR_WHITE;
 
             //Prepare values for LCD
-            update_temperature(data.front().temperature);
+            update_temperature(lines, data.front().temperature);
             update_lcd_colour(data.front().temperature);
-            update_humidity(data.front().humidity);
+            update_humidity(lines, data.front().humidity);
+
+            update_sensor_name(lines, data.front().sensor_name);
 
-            update_sensor_name(data.front().sensor_name);
+            populate_static_lines(lines);
 
-            populate_static_lines();
+            //Sent without copying the lines: the update shares them with every copy made of it
+            state.output.lines = std::make_shared<const std::list<lcd_update_line>>(std::move(lines));
 
             state.propagating = true;
         }
@@ -180,7 +186,7 @@ public:
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
 
-        get_messages<typename defs::lcd_update_out>(bags).push_back(state.output);
+        emplace_message<typename defs::lcd_update_out>(bags, state.output);
 
         return bags;
     }
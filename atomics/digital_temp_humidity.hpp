@@ -21,8 +21,12 @@
 #include <limits>
 #include <random>
 
+#include "../data_structures/message_view.hpp"
+#include "../data_structures/time_literals.hpp"
+
 using namespace cadmium;
 using namespace std;
+using namespace time_literals;
 
 //Port definition
 struct digitalTemperatureHumidity_defs{
@@ -53,9 +57,7 @@ public:
     }
 
     //Need to provide valid I2C pins to use this sensor
-    DigitalTemperatureHumidity(PinName sda, PinName scl) {
-        new (this) DigitalTemperatureHumidity(sda, scl, TIME("00:00:01:000"));
-    }
+    DigitalTemperatureHumidity(PinName sda, PinName scl) : DigitalTemperatureHumidity(sda, scl, to_time<TIME>(1_s)) {}
 
     //Constructor with Optional polling rate
     DigitalTemperatureHumidity(PinName sda, PinName scl, TIME rate) {
@@ -109,8 +111,8 @@ public:
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
 
-        get_messages<typename defs::temperature_out>(bags).push_back(state.temperature);
-        get_messages<typename defs::humidity_out>(bags).push_back(state.humidity);
+        emplace_message<typename defs::temperature_out>(bags, state.temperature);
+        emplace_message<typename defs::humidity_out>(bags, state.humidity);
 
         return bags;
     }
@@ -140,10 +142,30 @@ private:
 
     std::default_random_engine generator;
 
+#ifdef DISCO_FIXED_DRAWS
+    //Box-Muller from two engine draws, where normal_distribution draws until it accepts: every poll takes the same draws
+    double reading(double mean, double stddev) {
+        const double range = (double) generator.max() - (double) generator.min() + 1.0;
+        const double u1 = ((double) (generator() - generator.min()) + 1.0) / range;
+        const double u2 = (double) (generator() - generator.min()) / range;
+        return mean + stddev * sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+    }
+
+    void draw_readings() {
+        state.temperature = reading(20.0, 5.0);
+        state.humidity = reading(50.0, 5.0);
+    }
+#else
     //Random variables to stub sensor inputs
     normal temperature_distribution = normal(20.0,5.0);
     normal humidity_distribution = normal(50.0,5.0);
 
+    void draw_readings() {
+        state.temperature = temperature_distribution(generator);
+        state.humidity = humidity_distribution(generator);
+    }
+#endif
+
 public:
 
     TIME   pollingRate;
@@ -154,17 +176,23 @@ public:
     }
 
     //Dummy I2C pins for simulator
-    DigitalTemperatureHumidity(const char* sda, const char* scl) {
-        new (this) DigitalTemperatureHumidity(sda, scl, TIME("00:00:01:000"));
-    }
+    DigitalTemperatureHumidity(const char* sda, const char* scl) : DigitalTemperatureHumidity(sda, scl, to_time<TIME>(1_s)) {}
 
     //Can provide different polling rate
     DigitalTemperatureHumidity(const char* sda, const char* scl, TIME rate) {
         pollingRate = rate;
 
         //generate random values for temperature & humidity
-        state.temperature = temperature_distribution(generator);
-        state.humidity = humidity_distribution(generator);
+        draw_readings();
+    }
+
+    //Seeded, so independent runs see different (but repeatable) readings
+    DigitalTemperatureHumidity(const char* sda, const char* scl, TIME rate, unsigned int seed) {
+        pollingRate = rate;
+        generator.seed(seed);
+
+        //generate random values for temperature & humidity
+        draw_readings();
     }
 
     // state definition
@@ -174,14 +202,41 @@ public:
     };
     state_type state;
 
+#ifdef DISCO_FIXED_DRAWS
+    //Generator as text, so a checkpointed run draws the same readings
+    void save_random_state(std::ostream& os) const {
+        os << generator;
+    }
+
+    void load_random_state(std::istream& is) {
+        is >> generator;
+    }
+
+    //Engine draws per poll: two readings of two draws each
+    static constexpr unsigned long long draws_per_poll = 4;
+
+    //Moves the generator past n polls without computing their readings
+    void discard_polls(unsigned long long n) {
+        generator.discard(n * draws_per_poll);
+    }
+#else
+    //Generator and distributions as text, so a checkpointed run draws the same readings
+    void save_random_state(std::ostream& os) const {
+        os << generator << ' ' << temperature_distribution << ' ' << humidity_distribution;
+    }
+
+    void load_random_state(std::istream& is) {
+        is >> generator >> temperature_distribution >> humidity_distribution;
+    }
+#endif
+
     // ports definition
     using input_ports=std::tuple<>;
     using output_ports=std::tuple<typename defs::temperature_out, typename defs::humidity_out>;
 
     // internal transition
     void internal_transition() {
-        state.temperature = temperature_distribution(generator);
-        state.humidity = humidity_distribution(generator);
+        draw_readings();
     }
 
     // external transition
@@ -198,8 +253,8 @@ public:
     // output function
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
-        get_messages<typename defs::temperature_out>(bags).push_back(state.temperature);
-        get_messages<typename defs::humidity_out>(bags).push_back(state.humidity);
+        emplace_message<typename defs::temperature_out>(bags, state.temperature);
+        emplace_message<typename defs::humidity_out>(bags, state.humidity);
         return bags;
     }
 
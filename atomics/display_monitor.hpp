@@ -0,0 +1,125 @@
+/**
+* ARSLab - Carleton University
+*
+* Display Monitor:
+* Simulation-only observer for parameter sweeps. Listens to the sensor
+* samples leaving the switch and the updates leaving the arbiter, and
+* tallies them into a monitor_stats owned by whoever runs the simulation.
+*/
+
+#ifndef DISCO_DISPLAY_MONITOR_HPP
+#define DISCO_DISPLAY_MONITOR_HPP
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <limits>
+#include <math.h>
+#include <map>
+#include <string>
+
+#include "../data_structures/message_view.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+//Tallies for one run; merge runs with +=
+struct monitor_stats {
+    struct sensor_counts {
+        unsigned long long samples = 0;
+        unsigned long long nan_temperature = 0;
+        unsigned long long nan_humidity = 0;
+    };
+
+    unsigned long long lcd_updates = 0;
+    std::map<uint32_t, unsigned long long> lcd_colours;
+    std::map<std::string, sensor_counts> sensors;
+
+    monitor_stats& operator+=(const monitor_stats& other) {
+        lcd_updates += other.lcd_updates;
+        for (const auto& colour : other.lcd_colours) {
+            lcd_colours[colour.first] += colour.second;
+        }
+        for (const auto& sensor : other.sensors) {
+            sensors[sensor.first].samples += sensor.second.samples;
+            sensors[sensor.first].nan_temperature += sensor.second.nan_temperature;
+            sensors[sensor.first].nan_humidity += sensor.second.nan_humidity;
+        }
+        return *this;
+    }
+};
+
+//Port definition
+struct displayMonitor_defs {
+    struct sensor_in : public in_port<struct sensor_data> { };
+    struct lcd_in : public in_port<struct lcd_update> { };
+};
+
+template<typename TIME>
+class DisplayMonitor {
+    using defs=displayMonitor_defs; // putting definitions in context
+
+public:
+
+    DisplayMonitor() noexcept {
+        state.stats = nullptr;
+    }
+
+    //Tallies go to stats, which must outlive the simulation
+    DisplayMonitor(monitor_stats* stats) noexcept {
+        state.stats = stats;
+    }
+
+    // state definition
+    struct state_type{
+        monitor_stats* stats;
+    };
+    state_type state;
+
+    // ports definition
+    using input_ports=std::tuple<typename defs::sensor_in, typename defs::lcd_in>;
+    using output_ports=std::tuple<>;
+
+    // internal transition
+    void internal_transition() {}
+
+    // external transition
+    void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
+        if (!state.stats) return;
+
+        for (const auto &x : messages_in<typename defs::sensor_in>(mbs)) {
+            monitor_stats::sensor_counts& counts = state.stats->sensors[x.sensor_name];
+            counts.samples++;
+            if (isnan(x.temperature)) counts.nan_temperature++;
+            if (isnan(x.humidity)) counts.nan_humidity++;
+        }
+
+        for (const auto &x : messages_in<typename defs::lcd_in>(mbs)) {
+            state.stats->lcd_updates++;
+            state.stats->lcd_colours[x.lcd_colour]++;
+        }
+    }
+
+    // confluence transition
+    void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+    }
+
+    // output function
+    typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+        return bags;
+    }
+
+    // time_advance function
+    TIME time_advance() const {
+        return std::numeric_limits<TIME>::infinity();
+    }
+
+    friend std::ostringstream& operator<<(std::ostringstream& os, const typename DisplayMonitor<TIME>::state_type& i) {
+        os << "LCD updates: " << (i.stats ? i.stats->lcd_updates : 0);
+        return os;
+    }
+};
+
+#endif // DISCO_DISPLAY_MONITOR_HPP
@@ -20,6 +20,9 @@
 #include <algorithm>
 #include <limits>
 #include <random>
+#include <list>
+
+#include "../data_structures/message_view.hpp"
 
 #ifdef RT_ARM_MBED
     #include "../drivers/LCD_DISCO_F429ZI/LCD_DISCO_F429ZI.h"
@@ -70,16 +73,19 @@ struct lcd_update_line {
     }
 };
 
+//The lines of an update are not changed once it is sent, so every copy of it (bags, routing, the LCD's state) shares them
 struct lcd_update{
-    std::list<lcd_update_line> lines;
+    std::shared_ptr<const std::list<lcd_update_line>> lines;
     uint32_t lcd_colour;
     uint32_t text_colour;
 
     friend std::ostream& operator<<(std::ostream& os, const lcd_update& i) {
         os << "LCD Colour: " << to_string(i.lcd_colour) << ", Text Colour: " << to_string(i.text_colour) << "\n---Lines---\n";
 
-        for (lcd_update_line line : i.lines) {
-            os << line;
+        if (i.lines) {
+            for (const lcd_update_line& line : *i.lines) {
+                os << line;
+            }
         }
 
         return os;
@@ -128,16 +134,19 @@ public:
 
     // external transition
     void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
-        for(const auto &x : get_messages<typename defs::in>(mbs)){
-            state.output = x;
+        const message_view<lcd_update> updates = messages_in<typename defs::in>(mbs);
+        if (!updates.empty()) {
+            state.output = updates.back();
         }
 
         lcd.Clear(state.output.lcd_colour);
         lcd.SetBackColor(state.output.lcd_colour);
         lcd.SetTextColor(state.output.text_colour);
 
-        for (lcd_update_line line : state.output.lines) {
-            lcd.DisplayStringAt(0, LINE(line.line_index), (uint8_t*) line.characters, line.alignment);
+        if (state.output.lines) {
+            for (const lcd_update_line& line : *state.output.lines) {
+                lcd.DisplayStringAt(0, LINE(line.line_index), (uint8_t*) line.characters, line.alignment);
+            }
         }
 
     }
@@ -187,6 +196,9 @@ template<typename TIME>
 class LCD : public oestream_output<struct lcd_update, TIME, LCD_defs>{
 public:
     LCD() : oestream_output<struct lcd_update, TIME, LCD_defs>(LCD_FILE) {}
+
+    //Write screen updates to a different output file
+    LCD(const char* file_path) : oestream_output<struct lcd_update, TIME, LCD_defs>(file_path) {}
 };
 
 #endif //RT_ARM_MBED
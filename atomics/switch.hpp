@@ -24,8 +24,12 @@
 #include <limits>
 #include <random>
 
+#include "../data_structures/message_view.hpp"
+#include "../data_structures/time_literals.hpp"
+
 using namespace cadmium;
 using namespace std;
+using namespace time_literals;
 
 //Port definition
 struct switch_defs {
@@ -41,6 +45,9 @@ template<typename TIME>
 class Switch {
     using defs=switch_defs; // putting definitions in context
 
+    //Touches closer together than this are one press
+    inline static const TIME touch_debounce = to_time<TIME>(100_ms);
+
 public:
 
     // default constructor
@@ -76,10 +83,10 @@ public:
     // external transition
     void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
 
-        const auto coordinates_vector = get_messages<typename defs::ts_in>(mbs);
+        const message_view<cartesian_coordinates> coordinates_vector = messages_in<typename defs::ts_in>(mbs);
         if (coordinates_vector.size() == 1) {
             //Check if pressing bottom of screen + some debouncing
-            if (coordinates_vector.front().y > 200 && e > TIME("00:00:00:100")) {
+            if (coordinates_vector.front().y > 200 && e > touch_debounce) {
                 state.sensor_idx = (state.sensor_idx == 1) ? 0:1;
                 state.propagating = true;
             }
@@ -87,19 +94,19 @@ public:
         }
 
         //Update Temperature from Digital Sensor 1
-        for(const auto &x : get_messages<typename defs::temperature_in_1>(mbs)){
+        for(const auto &x : messages_in<typename defs::temperature_in_1>(mbs)){
             state.sensor_update[0].temperature = x;
             state.propagating = true;
         }
 
         //Update Humidity from Digital Sensor 1
-        for(const auto &x : get_messages<typename defs::humidity_in_1>(mbs)){
+        for(const auto &x : messages_in<typename defs::humidity_in_1>(mbs)){
             state.sensor_update[0].humidity = x;
             state.propagating = true;
         }
 
         //Update Temperature from Analog Sensor 2
-        for(const auto &x : get_messages<typename defs::temperature_in_2>(mbs)){
+        for(const auto &x : messages_in<typename defs::temperature_in_2>(mbs)){
             const unsigned int beta = 4275;
 
             //Input is a float between 0 and 1. Convert to a Temperature in Celsius
@@ -123,7 +130,7 @@ public:
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
 
-        get_messages<typename defs::sensor_out>(bags).push_back(state.sensor_update[state.sensor_idx]);
+        emplace_message<typename defs::sensor_out>(bags, state.sensor_update[state.sensor_idx]);
 
         return bags;
     }
@@ -21,6 +21,11 @@
 #include <limits>
 #include <random>
 
+#include "../data_structures/message_view.hpp"
+#include "../data_structures/time_literals.hpp"
+
+using namespace time_literals;
+
 //Describes touch position on screen
 struct cartesian_coordinates {
     int x;
@@ -60,9 +65,7 @@ public:
     TS_StateTypeDef TS_State;
 
     // default constructor
-    TouchScreen() noexcept {
-        new (this) TouchScreen(TIME("00:00:00:100"));
-    }
+    TouchScreen() noexcept : TouchScreen(to_time<TIME>(100_ms)) {}
 
     TouchScreen(TIME rate) {
         pollingRate = rate;
@@ -109,7 +112,7 @@ public:
         typename make_message_bags<output_ports>::type bags;
 
         if (TS_State.TouchDetected) {
-            get_messages<typename defs::out>(bags).push_back(state.coordinates);
+            emplace_message<typename defs::out>(bags, state.coordinates);
         }
 
         return bags;
@@ -148,6 +151,9 @@ public:
     TouchScreen() : iestream_input<struct cartesian_coordinates,TIME, TS_defs>(TS_FILE) {}
     TouchScreen(TIME rate) : iestream_input<struct cartesian_coordinates,TIME, TS_defs>(TS_FILE) {}
 
+    //Read touches from a different input file
+    TouchScreen(const char* file_path) : iestream_input<struct cartesian_coordinates,TIME, TS_defs>(file_path) {}
+
 };
 
 #endif // RT_ARM_MBED
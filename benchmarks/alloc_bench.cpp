@@ -0,0 +1,96 @@
+/**
+* ARSLab - Carleton University
+*
+* Allocation benchmark:
+* Runs DISCO_TOP without logging on cadmium's runner and on flat_runner,
+* with the global operator new served by malloc and by block_pool
+* (engine/pooled_allocation.hpp, as in the DISCO_POOLED_ALLOC build).
+* After a warm-up it counts, over the measured horizon, the operator new
+* calls and the mallocs behind them per transition, and the wall time.
+* Pooled, a steady-state run must make no mallocs at all.
+*
+* Usage (from top_model/): BENCH_ALLOC [HH:MM:SS:mmm] [warm-up]   default 01:00:00:000 00:01:00:000
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../engine/pooled_allocation.hpp"
+#include "../top_model/disco_top.hpp"
+#include "../engine/flat_runner.hpp"
+#include "../engine/transition_counter.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+struct alloc_result {
+    unsigned long long transitions;
+    unsigned long long allocations;
+    unsigned long long heap_allocations;
+    double elapsed;
+};
+
+//Counts from the end of the warm-up to the end of the run
+template<typename RUNNER>
+alloc_result measure(bool pooled, const TIME& warm_up, const TIME& horizon) {
+    block_pool::enabled = pooled;
+    disco_top_config config;
+    config.ts_input = "./inputs/TS_in.txt";
+    config.lcd_output = "/dev/null";
+
+    auto TOP = make_disco_top<TIME, counted>(config);
+    RUNNER r(TOP, {0});
+    r.run_until(warm_up);
+
+    alloc_result result;
+    transition_counter::reset();
+    const unsigned long long allocations = block_pool::allocations;
+    const unsigned long long heap_allocations = block_pool::heap_allocations;
+    auto start = hclock::now();
+    r.run_until(warm_up + horizon);
+    result.elapsed = chrono::duration<double>(hclock::now() - start).count();
+    result.allocations = block_pool::allocations - allocations;
+    result.heap_allocations = block_pool::heap_allocations - heap_allocations;
+    result.transitions = transition_counter::total();
+    return result;
+}
+
+void print_row(const char* runner, const char* heap, const alloc_result& result) {
+    cout << left << setw(10) << runner << setw(8) << heap << right
+         << setw(14) << result.transitions
+         << setw(14) << fixed << setprecision(3) << (double) result.allocations / result.transitions
+         << setw(14) << setprecision(3) << (double) result.heap_allocations / result.transitions
+         << setw(14) << result.heap_allocations
+         << setw(10) << setprecision(3) << result.elapsed << "\n";
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+    const TIME warm_up(argc > 2 ? argv[2] : "00:01:00:000");
+
+    using cadmium_runner=cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger>;
+    using flat=flat_runner<TIME, cadmium::logger::not_logger>;
+
+    const alloc_result cadmium_malloc = measure<cadmium_runner>(false, warm_up, horizon);
+    const alloc_result cadmium_pooled = measure<cadmium_runner>(true, warm_up, horizon);
+    const alloc_result flat_malloc = measure<flat>(false, warm_up, horizon);
+    const alloc_result flat_pooled = measure<flat>(true, warm_up, horizon);
+
+    cout << "# Horizon: " << horizon << " after a warm-up of " << warm_up << "\n";
+    cout << "#" << left << setw(9) << "runner" << setw(8) << "heap" << right << setw(14) << "transitions"
+         << setw(14) << "new/trans" << setw(14) << "malloc/trans" << setw(14) << "mallocs" << setw(10) << "wall (s)" << "\n";
+    print_row("cadmium", "malloc", cadmium_malloc);
+    print_row("cadmium", "pooled", cadmium_pooled);
+    print_row("flat", "malloc", flat_malloc);
+    print_row("flat", "pooled", flat_pooled);
+
+    const bool ok = cadmium_pooled.heap_allocations == 0 && flat_pooled.heap_allocations == 0;
+    cout << "# No mallocs in the steady state when pooled: " << (ok ? "yes" : "NO") << "\n";
+    return ok ? 0 : 1;
+}
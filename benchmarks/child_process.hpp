@@ -0,0 +1,55 @@
+/**
+* ARSLab - Carleton University
+*
+* Child process runs for the benchmarks:
+* in_child runs a bench in a forked child and waits for it, so each run's
+* peak RSS and heap are its own. The overload with a result passes the
+* double the bench returns back through a pipe.
+*/
+
+#ifndef DISCO_CHILD_PROCESS_HPP
+#define DISCO_CHILD_PROCESS_HPP
+
+#include <iostream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+//Runs bench in a child process and waits for it
+template<typename BENCH>
+bool in_child(BENCH bench) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        bench();
+        std::cout.flush();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+//Runs bench in a child process; its result comes back through a pipe
+template<typename BENCH>
+bool in_child(BENCH bench, double& result) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        const double value = bench();
+        std::cout.flush();
+        const bool written = write(fds[1], &value, sizeof(value)) == (ssize_t) sizeof(value);
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    const bool read_ok = read(fds[0], &result, sizeof(result)) == (ssize_t) sizeof(result);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return read_ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+#endif // DISCO_CHILD_PROCESS_HPP
@@ -0,0 +1,126 @@
+/**
+* ARSLab - Carleton University
+*
+* Copy benchmark:
+* Every copy of a message on its way through the atomics lands on the
+* heap (bag buffers, a vector copied out of a bag, the list of an LCD
+* update), so it is counted by block_pool (engine/pooled_allocation.hpp).
+* Prints the heap blocks and bytes per sensor sample of
+*  - the message path alone: switch1's transition and output, then
+*    arbiter1's and the display monitor's, with bags handed on without
+*    the engine;
+*  - DISCO_TOP on cadmium's runner, coupled and fused, where the engine
+*    also copies bags while routing and formats states and messages.
+*
+* Usage (from top_model/): BENCH_COPY [HH:MM:SS:mmm] [samples]   default 01:00:00:000 100000
+*/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../engine/pooled_allocation.hpp"
+#include "../top_model/disco_top.hpp"
+
+using namespace std;
+
+using TIME = NDTime;
+
+struct heap_use {
+    unsigned long long blocks = block_pool::allocations;
+    unsigned long long bytes = block_pool::allocated_bytes;
+};
+
+void print_row(const char* name, const heap_use& from, unsigned long long samples) {
+    cout << left << setw(10) << name << right
+         << setw(12) << samples
+         << setw(16) << fixed << setprecision(2) << (double) (block_pool::allocations - from.blocks) / samples
+         << setw(16) << (double) (block_pool::allocated_bytes - from.bytes) / samples << "\n";
+}
+
+//One sample through switch1 -> arbiter1 -> monitor1, the output bags moved on as inputs
+void run_path(unsigned long long samples) {
+    Switch<TIME> sensor_switch;
+    Arbiter<TIME> arbiter;
+    monitor_stats stats;
+    DisplayMonitor<TIME> monitor(&stats);
+
+    using switch_inputs=typename make_message_bags<typename Switch<TIME>::input_ports>::type;
+    using arbiter_inputs=typename make_message_bags<typename Arbiter<TIME>::input_ports>::type;
+    using monitor_inputs=typename make_message_bags<typename DisplayMonitor<TIME>::input_ports>::type;
+
+    heap_use from;
+    for (unsigned long long i = 0; i < samples; i++) {
+        switch_inputs readings;
+        get_messages<switch_defs::temperature_in_1>(readings).push_back(20.0f + (i % 10));
+
+        sensor_switch.external_transition(TIME(), std::move(readings));
+        auto sensor = sensor_switch.output();
+        sensor_switch.internal_transition();
+
+        arbiter_inputs arbiter_in;
+        get_messages<arbiter_defs::sensor_in>(arbiter_in) = std::move(get_messages<switch_defs::sensor_out>(sensor));
+        arbiter.external_transition(TIME(), std::move(arbiter_in));
+        auto update = arbiter.output();
+        arbiter.internal_transition();
+
+        monitor_inputs monitor_in;
+        get_messages<displayMonitor_defs::lcd_in>(monitor_in) = std::move(get_messages<arbiter_defs::lcd_update_out>(update));
+        monitor.external_transition(TIME(), std::move(monitor_in));
+    }
+    print_row("path", from, samples);
+}
+
+//Whether a logged outbox holds any message: cadmium prints the bag of every output port, "{}" when empty
+bool carries_messages(const std::string& outbox) {
+    for (size_t i = outbox.find('{'); i != std::string::npos; i = outbox.find('{', i + 1)) {
+        if (i + 1 < outbox.size() && outbox[i + 1] != '}') return true;
+    }
+    return false;
+}
+
+//Counts the sensor models' outputs that hold a sample, as the fusion benchmark does
+struct sample_counter {
+    inline static unsigned long long samples = 0;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::sim_messages_collect>::value) {
+            const std::string& id = std::get<1>(std::tie(params...));
+            const bool sensor = id.compare(0, 13, "digital_temp_") == 0 || id.compare(0, 11, "analog_temp") == 0;
+            if (sensor && carries_messages(std::get<2>(std::tie(params...)))) samples++;
+        }
+    }
+};
+
+void run_top(const char* name, const TIME& horizon, bool fuse) {
+    disco_top_config config;
+    config.ts_input = "./inputs/TS_in.txt";
+    config.lcd_output = "/dev/null";
+    config.fuse_switch_arbiter = fuse;
+
+    auto TOP = make_disco_top<TIME>(config);
+    cadmium::dynamic::engine::runner<TIME, sample_counter> r(TOP, {0});
+    sample_counter::samples = 0;
+
+    heap_use from;
+    r.run_until(horizon);
+    print_row(name, from, sample_counter::samples);
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+    const unsigned long long samples = argc > 2 ? stoull(argv[2]) : 100000;
+
+    cout << "# Heap blocks and bytes per sensor sample (TOP runs: " << horizon << ")\n";
+    cout << "#" << left << setw(9) << "run" << right << setw(12) << "samples" << setw(16) << "blocks/sample"
+         << setw(16) << "bytes/sample" << "\n";
+    run_path(samples);
+    run_top("coupled", horizon, false);
+    run_top("fused", horizon, true);
+    return 0;
+}
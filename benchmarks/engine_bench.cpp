@@ -0,0 +1,71 @@
+/**
+* ARSLab - Carleton University
+*
+* Engine benchmark:
+* Runs DISCO_TOP on cadmium's dynamic engine (make_disco_top) and on the
+* static engine (disco_static_top) for the same horizon, without logging,
+* and reports transitions/sec and peak RSS of each. Every engine runs in
+* its own child process so the peak RSS figures do not mix.
+*
+* Usage (from top_model/): BENCH_ENGINE [HH:MM:SS:mmm]   default 01:00:00:000
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/disco_top.hpp"
+#include "../top_model/static_top.hpp"
+#include "../engine/transition_counter.hpp"
+#include "child_process.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+void report(const char* name, double elapsed) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    cout << left << setw(10) << name << right
+         << setw(14) << transition_counter::total()
+         << setw(12) << fixed << setprecision(3) << elapsed
+         << setw(16) << setprecision(0) << transition_counter::total() / elapsed
+         << setw(16) << usage.ru_maxrss << "\n";
+}
+
+void run_dynamic(const TIME& horizon) {
+    auto TOP = make_disco_top<TIME, counted>();
+    cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger> r(TOP, {0});
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    report("dynamic", chrono::duration<double>(hclock::now() - start).count());
+}
+
+void run_static(const TIME& horizon) {
+    cadmium::engine::runner<TIME, disco_static_top<counted>::type, cadmium::logger::not_logger> r({0});
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    report("static", chrono::duration<double>(hclock::now() - start).count());
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+
+    cout << "Horizon: " << horizon << "\n";
+    cout << left << setw(10) << "engine" << right
+         << setw(14) << "transitions" << setw(12) << "wall (s)" << setw(16) << "transitions/s"
+         << setw(16) << "peak RSS (kB)" << "\n";
+
+    bool ok = in_child([&]() { run_dynamic(horizon); });
+    ok = in_child([&]() { run_static(horizon); }) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/**
+* ARSLab - Carleton University
+*
+* Fleet benchmark:
+* Runs fleet TOPs (fleet_top.hpp) of K = 1, 2, 4, ... chains without
+* logging, with and without cross-links, and prints events/sec and peak
+* RSS against K. Each size runs in its own child process so the peak RSS
+* figures do not mix. The output is a whitespace separated table with a
+* '#' header, ready for gnuplot.
+*
+* Usage (from top_model/): BENCH_FLEET [HH:MM:SS:mmm] [max K]   default 00:10:00:000 256
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include <sys/resource.h>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/fleet_top.hpp"
+#include "../engine/transition_counter.hpp"
+#include "child_process.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+void run_fleet(const TIME& horizon, size_t chains, bool cross_links) {
+    fleet_config config;
+    config.chains = chains;
+    config.cross_links = cross_links;
+
+    auto TOP = make_fleet_top<TIME, counted>(config);
+    cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger> r(TOP, {0});
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    cout << setw(8) << chains << setw(7) << (cross_links ? 1 : 0)
+         << setw(9) << 1 + 5 * chains
+         << setw(14) << transition_counter::total()
+         << setw(12) << fixed << setprecision(3) << elapsed
+         << setw(14) << setprecision(0) << transition_counter::total() / elapsed
+         << setw(16) << usage.ru_maxrss << "\n";
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "00:10:00:000");
+    const size_t max_chains = argc > 2 ? stoul(argv[2]) : 256;
+
+    cout << "# Horizon: " << horizon << "\n";
+    cout << "#" << setw(7) << "chains" << setw(7) << "cross" << setw(9) << "models"
+         << setw(14) << "transitions" << setw(12) << "wall (s)" << setw(14) << "events/s"
+         << setw(16) << "peak RSS (kB)" << "\n";
+
+    bool ok = true;
+    for (bool cross_links : {false, true}) {
+        for (size_t chains = 1; chains <= max_chains; chains *= 2) {
+            ok = in_child([&]() { run_fleet(horizon, chains, cross_links); }) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
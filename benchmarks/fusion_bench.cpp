@@ -0,0 +1,112 @@
+/**
+* ARSLab - Carleton University
+*
+* Fusion benchmark:
+* Runs DISCO_TOP as built (switch1 -> arbiter1) and with the pair fused
+* into switch_arbiter1 (engine/fused_model.hpp), with the same sensor seed.
+* For each it prints the engine rounds (collect/route/transition
+* iterations), the sensor samples, rounds per sample and wall time. It
+* checks that both runs write the same, non-empty, LCD output (to
+* LCD_out_coupled.txt and LCD_out_fused.txt in the outputs directory).
+*
+* Usage (from top_model/): BENCH_FUSION [HH:MM:SS:mmm] [outputs]   default 24:00:00:000 ./outputs
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/disco_top.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+//Whether a logged outbox holds any message: cadmium prints the bag of every output port, "{}" when empty
+bool carries_messages(const std::string& outbox) {
+    for (size_t i = outbox.find('{'); i != std::string::npos; i = outbox.find('{', i + 1)) {
+        if (i + 1 < outbox.size() && outbox[i + 1] != '}') return true;
+    }
+    return false;
+}
+
+//Counts engine rounds and the sensor models' outputs that hold a sample
+struct round_counter {
+    inline static unsigned long long rounds = 0;
+    inline static unsigned long long samples = 0;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::run_global_time>::value) {
+            rounds++;
+        } else if constexpr (std::is_same<EVENT, cadmium::logger::sim_messages_collect>::value) {
+            const std::string& id = std::get<1>(std::tie(params...));
+            const bool sensor = id.compare(0, 13, "digital_temp_") == 0 || id.compare(0, 11, "analog_temp") == 0;
+            if (sensor && carries_messages(std::get<2>(std::tie(params...)))) samples++;
+        }
+    }
+};
+
+string read_file(const string& path) {
+    ifstream in(path);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+void run(const char* name, const TIME& horizon, bool fuse, const string& lcd_output) {
+    disco_top_config config;
+    config.lcd_output = lcd_output;
+    config.seeded = true;
+    config.seed = 1;
+    config.fuse_switch_arbiter = fuse;
+
+    round_counter::rounds = 0;
+    round_counter::samples = 0;
+    {
+        auto TOP = make_disco_top<TIME>(config);
+        cadmium::dynamic::engine::runner<TIME, round_counter> r(TOP, {0});
+
+        auto start = hclock::now();
+        r.run_until(horizon);
+        const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+        cout << left << setw(10) << name << right
+             << setw(12) << round_counter::rounds
+             << setw(12) << round_counter::samples
+             << setw(16) << fixed << setprecision(3) << (double) round_counter::rounds / round_counter::samples
+             << setw(12) << elapsed << "\n";
+    } //LCD file closed
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "24:00:00:000");
+    const string outputs = argc > 2 ? argv[2] : "./outputs";
+
+    cout << "Horizon: " << horizon << "\n";
+    cout << left << setw(10) << "TOP" << right << setw(12) << "rounds" << setw(12) << "samples"
+         << setw(16) << "rounds/sample" << setw(12) << "wall (s)" << "\n";
+
+    run("coupled", horizon, false, outputs + "/LCD_out_coupled.txt");
+    run("fused", horizon, true, outputs + "/LCD_out_fused.txt");
+
+    const string coupled = read_file(outputs + "/LCD_out_coupled.txt");
+    if (coupled.empty()) {
+        cerr << "No LCD output in " << outputs << " (does the directory exist?)" << endl;
+        return 1;
+    }
+    if (coupled != read_file(outputs + "/LCD_out_fused.txt")) {
+        cerr << "The fused TOP wrote a different LCD_out.txt" << endl;
+        return 1;
+    }
+    cout << "LCD output identical\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+* ARSLab - Carleton University
+*
+* Logger benchmark:
+* Runs DISCO_TOP with the text formatter logger, the same logger behind
+* the asynchronous sink, and the binary trace logger (all logging messages
+* and global time) and reports events/sec and bytes per event for each.
+* Then the text logger on flat_runner, logging everything and filtered to
+* arbiter1's LCD updates (loggers/filtered_logger.hpp); compare the wall
+* times of those two.
+*
+* Usage (from top_model/): BENCH_LOGGER [HH:MM:SS:mmm]   default 01:00:00:000
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/disco_top.hpp"
+#include "../loggers/binary_logger.hpp"
+#include "../loggers/async_sink.hpp"
+#include "../loggers/filtered_logger.hpp"
+#include "../engine/flat_runner.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+static std::ofstream out_data;
+static std::ostream* out = &out_data;
+
+struct bench_sink_provider{
+    static std::ostream& sink(){
+        return *out;
+    }
+};
+
+//Counts the events the loggers under test see
+struct event_counter {
+    static unsigned long long events;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... ps) {
+        if (std::is_same<DECLARED_SOURCE, cadmium::logger::logger_messages>::value ||
+            std::is_same<DECLARED_SOURCE, cadmium::logger::logger_global_time>::value) {
+            events++;
+        }
+    }
+};
+unsigned long long event_counter::events = 0;
+
+using text_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<TIME>, bench_sink_provider>;
+using text_global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, bench_sink_provider>;
+using text_top=cadmium::logger::multilogger<event_counter, text_messages, text_global_time>;
+
+using binary_messages=binary_logger<cadmium::logger::logger_messages, bench_sink_provider>;
+using binary_global_time=binary_logger<cadmium::logger::logger_global_time, bench_sink_provider>;
+using binary_top=cadmium::logger::multilogger<event_counter, binary_messages, binary_global_time>;
+
+constexpr char arbiter1_id[] = "arbiter1";
+using lcd_updates=trace_selection<model_ports<arbiter1_id, arbiter_defs::lcd_update_out>>;
+using filtered_top=filtered_logger<lcd_updates, text_top>;
+
+template<typename LOGGER, typename RUNNER = cadmium::dynamic::engine::runner<TIME, LOGGER>>
+void bench(const char* name, const char* file, const TIME& horizon, bool async = false) {
+    out_data.open(file, std::ios::binary | std::ios::trunc);
+    event_counter::events = 0;
+
+    std::unique_ptr<async_log_stream> async_out;
+    if (async) {
+        async_out.reset(new async_log_stream(out_data));
+        out = async_out.get();
+    }
+
+    auto TOP = make_disco_top<TIME>();
+    RUNNER r(TOP, {0});
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    if (async_out) {
+        async_out->close();
+    }
+    out_data.flush();
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+    out = &out_data;
+
+    const double bytes = (double) out_data.tellp();
+    out_data.close();
+
+    cout << left << setw(10) << name << right
+         << setw(12) << event_counter::events
+         << setw(12) << fixed << setprecision(3) << elapsed
+         << setw(14) << setprecision(0) << event_counter::events / elapsed
+         << setw(14) << bytes
+         << setw(12) << setprecision(1) << bytes / event_counter::events << "\n";
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+
+    cout << "Horizon: " << horizon << "\n";
+    cout << left << setw(10) << "logger" << right
+         << setw(12) << "events" << setw(12) << "wall (s)" << setw(14) << "events/sec"
+         << setw(14) << "bytes" << setw(12) << "bytes/event" << "\n";
+
+    bench<text_top>("text", "bench_output.txt", horizon);
+    bench<text_top>("async", "bench_output_async.txt", horizon, true);
+    bench<binary_top>("binary", "bench_output.bin", horizon);
+    bench<text_top, flat_runner<TIME, text_top>>("flat", "bench_output_flat.txt", horizon);
+    bench<filtered_top, flat_runner<TIME, filtered_top>>("filtered", "bench_output_filtered.txt", horizon);
+
+    ifstream text("bench_output.txt", ios::binary), async("bench_output_async.txt", ios::binary);
+    const bool identical = equal(istreambuf_iterator<char>(text), istreambuf_iterator<char>(),
+                                 istreambuf_iterator<char>(async), istreambuf_iterator<char>());
+    cout << "Async log identical to text log: " << (identical ? "yes" : "NO") << "\n";
+    return identical ? 0 : 1;
+}
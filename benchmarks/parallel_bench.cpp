@@ -0,0 +1,115 @@
+/**
+* ARSLab - Carleton University
+*
+* Parallel benchmark:
+* Runs a fleet TOP (fleet_top.hpp) of K chains on flat_runner, serially
+* and with a work_stealing_pool of T = 1, 2, 4, ... threads, without
+* logging, and prints events/sec and the speed-up over the serial run
+* against T. Each run is in its own child process.
+*
+* Before timing, the first simulated minute of every T must log the same
+* trace (messages and states, hashed) as the serial run.
+*
+* Usage (from top_model/): BENCH_PARALLEL [HH:MM:SS:mmm] [K] [max T]   default 00:10:00:000 256 <cores>
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/fleet_top.hpp"
+#include "../engine/flat_runner.hpp"
+#include "../engine/transition_counter.hpp"
+#include "../engine/work_stealing_pool.hpp"
+#include "child_process.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+//FNV-1a over every logged event, in order
+struct trace_hash {
+    inline static uint64_t value = 14695981039346656037ull;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        ostringstream oss;
+        oss << typeid(EVENT).name();
+        ((oss << ' ' << params), ...);
+        for (char c : oss.str()) {
+            value = (value ^ (unsigned char) c) * 1099511628211ull;
+        }
+    }
+};
+
+//threads 0: serial, without a pool
+uint64_t hash_run(size_t chains, unsigned int threads, const TIME& horizon) {
+    fleet_config config;
+    config.chains = chains;
+    config.cross_links = true;
+
+    unique_ptr<work_stealing_pool> pool(threads ? new work_stealing_pool(threads) : nullptr);
+    trace_hash::value = 14695981039346656037ull;
+    flat_runner<TIME, trace_hash> r(make_fleet_top<TIME>(config), {0}, pool.get());
+    r.run_until(horizon);
+    return trace_hash::value;
+}
+
+//Events/sec of the run
+double run_fleet(size_t chains, unsigned int threads, const TIME& horizon, double serial) {
+    fleet_config config;
+    config.chains = chains;
+    config.cross_links = true;
+
+    unique_ptr<work_stealing_pool> pool(threads ? new work_stealing_pool(threads) : nullptr);
+    auto TOP = make_fleet_top<TIME, counted>(config);
+    flat_runner<TIME, cadmium::logger::not_logger> r(TOP, {0}, pool.get());
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+    const double events = transition_counter::total() / elapsed;
+
+    cout << setw(8) << (threads ? to_string(threads) : "serial")
+         << setw(14) << transition_counter::total()
+         << setw(12) << fixed << setprecision(3) << elapsed
+         << setw(14) << setprecision(0) << events
+         << setw(10) << setprecision(2) << (serial > 0 ? events / serial : 1.0)
+         << setw(10) << (pool ? pool->steals() : 0) << "\n";
+    return events;
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "00:10:00:000");
+    const size_t chains = argc > 2 ? stoul(argv[2]) : 256;
+    const unsigned int max_threads = argc > 3 ? (unsigned int) stoul(argv[3]) : max(1u, thread::hardware_concurrency());
+
+    const uint64_t serial_hash = hash_run(chains, 0, TIME("00:01:00:000"));
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        if (hash_run(chains, threads, TIME("00:01:00:000")) != serial_hash) {
+            cerr << "The trace on " << threads << " threads differs from the serial trace" << endl;
+            return 1;
+        }
+    }
+
+    cout << "# Horizon: " << horizon << ", " << chains << " chains with cross-links, " << thread::hardware_concurrency() << " cores\n";
+    cout << "# Traces of the first minute identical to the serial run for every thread count\n";
+    cout << "#" << setw(7) << "threads" << setw(14) << "transitions" << setw(12) << "wall (s)" << setw(14) << "events/sec"
+         << setw(10) << "speed-up" << setw(10) << "steals" << "\n";
+
+    double serial = 0;
+    if (!in_child([&]() { return run_fleet(chains, 0, horizon, 0); }, serial)) return 1;
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        double events = 0;
+        if (!in_child([&]() { return run_fleet(chains, threads, horizon, serial); }, events)) return 1;
+    }
+    return 0;
+}
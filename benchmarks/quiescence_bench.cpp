@@ -0,0 +1,81 @@
+/**
+* ARSLab - Carleton University
+*
+* Quiescence benchmark:
+* Runs fleet TOPs (fleet_top.hpp) of K chains with S = 0, 1, 4, 16 spare
+* (unwired) digital sensors per chain on flat_runner without logging:
+* stepping every poll, skipping the spares' polls, and skipping with every
+* jump verified. Prints the wall time of each, the speed-up of skipping
+* and the polls skipped. Every model's state at the horizon must be the
+* same whether the polls were stepped or skipped.
+*
+* Usage (from top_model/): BENCH_QUIESCENCE [HH:MM:SS:mmm] [K]   default 01:00:00:000 16
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/fleet_top.hpp"
+#include "../top_model/disco_quiescence.hpp"
+#include "../engine/flat_runner.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+//Wall time of the run; states gets every atomic's state at the horizon
+double run_fleet(size_t chains, size_t spares, idle_polls polls, const TIME& horizon, vector<string>& states) {
+    fleet_config config;
+    config.chains = chains;
+    config.spare_sensors = spares;
+
+    auto TOP = make_fleet_top<TIME, quiescent>(config);
+    flat_runner<TIME, cadmium::logger::not_logger> r(TOP, {0}, nullptr, polls);
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+    states.clear();
+    for (const auto& model : TOP->_models) {
+        auto atomic = dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(model);
+        states.push_back(model->get_id() + ": " + atomic->model_state_as_string());
+    }
+    return elapsed;
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+    const size_t chains = argc > 2 ? stoul(argv[2]) : 16;
+
+    cout << "# Horizon: " << horizon << ", " << chains << " chains\n";
+    cout << "#" << setw(7) << "spares" << setw(12) << "step (s)" << setw(12) << "skip (s)" << setw(12) << "verify (s)"
+         << setw(10) << "speed-up" << setw(14) << "skipped" << "\n";
+
+    bool ok = true;
+    for (size_t spares : {0, 1, 4, 16}) {
+        vector<string> stepped_states, skipped_states, verified_states;
+        const double stepped = run_fleet(chains, spares, idle_polls::step, horizon, stepped_states);
+        skipped_polls::count = 0;
+        const double skipped = run_fleet(chains, spares, idle_polls::skip, horizon, skipped_states);
+        const unsigned long long polls = skipped_polls::count;
+        const double verified = run_fleet(chains, spares, idle_polls::verify, horizon, verified_states);
+
+        cout << setw(8) << spares << fixed << setprecision(3)
+             << setw(12) << stepped << setw(12) << skipped << setw(12) << verified
+             << setw(10) << setprecision(2) << stepped / skipped
+             << setw(14) << polls << "\n";
+        if (skipped_states != stepped_states || verified_states != stepped_states) {
+            cerr << "States at the horizon differ with " << spares << " spares per chain" << endl;
+            ok = false;
+        }
+    }
+    cout << "# States at the horizon identical whether polls were stepped or skipped: " << (ok ? "yes" : "NO") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/**
+* ARSLab - Carleton University
+*
+* Routing benchmark:
+* Runs fan-in TOPs (make_fan_in_top: N analog sensors into one switch) for
+* N = 1, 2, 4, ... without logging. Each N runs on cadmium's dynamic runner
+* and on flat_runner, with the sensors directly in TOP and inside a nested
+* sensor_bank, and the events/sec and peak RSS of each are printed. Every
+* run is in its own child process so the peak RSS figures do not mix.
+*
+* Before timing, every N is checked: its first simulated minute must log
+* the same trace (hashed) on both runners, for each topology.
+*
+* Usage (from top_model/): BENCH_ROUTING [HH:MM:SS:mmm] [max N]   default 00:10:00:000 1024
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+#include <sys/resource.h>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/fleet_top.hpp"
+#include "../engine/flat_runner.hpp"
+#include "../engine/transition_counter.hpp"
+#include "child_process.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+//FNV-1a over every logged event, in order
+struct trace_hash {
+    inline static uint64_t value = 14695981039346656037ull;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        ostringstream oss;
+        oss << typeid(EVENT).name();
+        ((oss << ' ' << params), ...);
+        for (char c : oss.str()) {
+            value = (value ^ (unsigned char) c) * 1099511628211ull;
+        }
+    }
+};
+
+template<typename RUNNER>
+uint64_t hash_run(const fan_in_config& config, const TIME& horizon) {
+    trace_hash::value = 14695981039346656037ull;
+    RUNNER r(make_fan_in_top<TIME>(config), {0});
+    r.run_until(horizon);
+    return trace_hash::value;
+}
+
+template<typename RUNNER>
+void run_fan_in(const char* name, const TIME& horizon, size_t sensors, bool nested) {
+    fan_in_config config;
+    config.sensors = sensors;
+    config.nested = nested;
+
+    auto TOP = make_fan_in_top<TIME, counted>(config);
+    RUNNER r(TOP, {0});
+
+    auto start = hclock::now();
+    r.run_until(horizon);
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    cout << left << setw(10) << name << right
+         << setw(8) << sensors << setw(8) << (nested ? 1 : 0)
+         << setw(14) << transition_counter::total()
+         << setw(12) << fixed << setprecision(3) << elapsed
+         << setw(14) << setprecision(0) << transition_counter::total() / elapsed
+         << setw(16) << usage.ru_maxrss << "\n";
+}
+
+int main(int argc, char ** argv) {
+    using cadmium_runner=cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger>;
+    using fast_runner=flat_runner<TIME, cadmium::logger::not_logger>;
+
+    const TIME horizon(argc > 1 ? argv[1] : "00:10:00:000");
+    const size_t max_sensors = argc > 2 ? stoul(argv[2]) : 1024;
+
+    bool ok = true;
+    for (size_t sensors = 1; sensors <= max_sensors; sensors *= 2) {
+        fan_in_config config;
+        config.sensors = sensors;
+        for (bool nested : {false, true}) {
+            config.nested = nested;
+            const uint64_t expected = hash_run<cadmium::dynamic::engine::runner<TIME, trace_hash>>(config, TIME("00:01:00:000"));
+            if (hash_run<flat_runner<TIME, trace_hash>>(config, TIME("00:01:00:000")) != expected) {
+                cerr << "Trace mismatch with " << sensors << " sensors" << (nested ? ", nested" : "") << endl;
+                ok = false;
+            }
+        }
+    }
+    if (!ok) return 1;
+
+    cout << "# Horizon: " << horizon << "\n";
+    cout << "#" << setw(9) << "runner" << setw(8) << "sensors" << setw(8) << "nested"
+         << setw(14) << "transitions" << setw(12) << "wall (s)" << setw(14) << "events/s"
+         << setw(16) << "peak RSS (kB)" << "\n";
+
+    for (size_t sensors = 1; sensors <= max_sensors; sensors *= 2) {
+        for (bool nested : {false, true}) {
+            ok = in_child([&]() { run_fan_in<cadmium_runner>("cadmium", horizon, sensors, nested); }) && ok;
+            ok = in_child([&]() { run_fan_in<fast_runner>("flat", horizon, sensors, nested); }) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/**
+* ARSLab - Carleton University
+*
+* Segment benchmark:
+* Runs DISCO_TOP over the horizon sequentially, then cut into S segments
+* (top_model/segments.hpp) on up to S threads, each with the messages and
+* global time logged and the LCD output written. Prints the wall time of
+* each, the prediction's share and the speed-up. The segmented run is
+* repeated from deliberately wrong predictions (made with the digital
+* sensor seeded differently) to show the re-runs. Both segmented runs
+* must write the sequential run's log and LCD output byte for byte.
+*
+* Usage (from top_model/): BENCH_SEGMENTS [HH:MM:SS:mmm] [S] [outputs]   default 24:00:00:000 <cores> ./outputs
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/segments.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<TIME>, segment_sink_provider>;
+using log_global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, segment_sink_provider>;
+using logger_top=cadmium::logger::multilogger<log_messages, log_global_time>;
+
+string contents(const string& path) {
+    ifstream in(path, ios::binary);
+    ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+void print_row(const char* name, double wall, double sequential, const time_parallel_report* report) {
+    cout << left << setw(12) << name << right << fixed
+         << setw(10) << setprecision(3) << wall
+         << setw(10) << setprecision(2) << sequential / wall;
+    if (report) {
+        cout << setw(8) << report->rounds << setw(8) << report->runs - report->segments;
+    }
+    cout << "\n";
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "24:00:00:000");
+    const size_t segments = argc > 2 ? stoul(argv[2]) : max(1u, thread::hardware_concurrency());
+    const string outputs = argc > 3 ? argv[3] : "./outputs";
+
+    disco_top_config config;
+    config.ts_input = "./inputs/TS_in.txt";
+
+    //Sequential
+    config.lcd_output = outputs + "/LCD_bench_sequential.txt";
+    auto start = hclock::now();
+    {
+        ofstream log(outputs + "/log_bench_sequential.txt", ios::binary);
+        segment_sink_provider::stream = &log;
+        auto TOP = make_disco_top<TIME>(config);
+        cadmium::dynamic::engine::runner<TIME, logger_top> r(TOP, {0});
+        r.run_until(horizon);
+    }
+    const double sequential = chrono::duration<double>(hclock::now() - start).count();
+
+    const vector<TIME> boundaries = segment_boundaries(TIME{0}, horizon, segments);
+    config.lcd_output = outputs + "/LCD_bench_segments.txt";
+    const string segments_log = outputs + "/log_bench_segments.txt";
+    const string expected_lcd = contents(outputs + "/LCD_bench_sequential.txt");
+    const string expected_log = contents(outputs + "/log_bench_sequential.txt");
+
+    auto same_output = [&]() {
+        return contents(config.lcd_output) == expected_lcd && contents(segments_log) == expected_log;
+    };
+
+    //Predicted
+    start = hclock::now();
+    const vector<string> predicted = predict_segment_starts(config, boundaries);
+    const double prediction = chrono::duration<double>(hclock::now() - start).count();
+    const time_parallel_report report = run_segments<TIME, logger_top>(config, segments_log, boundaries, predicted, (unsigned int) segments);
+    const double segmented = chrono::duration<double>(hclock::now() - start).count();
+    const bool predicted_ok = same_output();
+
+    //Every start mispredicted
+    disco_top_config reseeded = config;
+    reseeded.seeded = true;
+    reseeded.seed = 2;
+    start = hclock::now();
+    const vector<string> wrong_starts = predict_segment_starts(reseeded, boundaries);
+    const time_parallel_report wrong = run_segments<TIME, logger_top>(config, segments_log, boundaries, wrong_starts, (unsigned int) segments);
+    const double mispredicted = chrono::duration<double>(hclock::now() - start).count();
+    const bool mispredicted_ok = same_output();
+
+    cout << "# Horizon: " << horizon << ", " << segments << " segments, " << thread::hardware_concurrency() << " cores\n";
+    cout << "#" << left << setw(11) << "run" << right << setw(10) << "wall (s)" << setw(10) << "speed-up"
+         << setw(8) << "rounds" << setw(8) << "re-runs" << "\n";
+    print_row("sequential", sequential, sequential, nullptr);
+    print_row("segmented", segmented, sequential, &report);
+    print_row("mispredict", mispredicted, sequential, &wrong);
+    cout << "# Prediction: " << setprecision(3) << prediction << " s of the segmented run\n";
+    cout << "# Log and LCD output identical to the sequential run: segmented " << (predicted_ok ? "yes" : "NO")
+         << ", mispredicted " << (mispredicted_ok ? "yes" : "NO") << "\n";
+
+    for (const string& file : {outputs + "/LCD_bench_sequential.txt", outputs + "/log_bench_sequential.txt", config.lcd_output, segments_log}) {
+        remove(file.c_str());
+    }
+    return predicted_ok && mispredicted_ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+/**
+* ARSLab - Carleton University
+*
+* State log benchmark:
+* Runs DISCO_TOP (seeded) twice, logging global time and model states as
+* text: every state, then only changed states with keyframes
+* (loggers/delta_state_logger.hpp). Prints the state lines and bytes of
+* each log and the reduction. It also checks that every model's state,
+* rebuilt from the delta log, matches the full log at every event time.
+*
+* Usage (from top_model/): BENCH_STATE_LOG [HH:MM:SS:mmm] [keyframe]   default 01:00:00:000 00:10:00:000
+*/
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <map>
+#include <vector>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/disco_top.hpp"
+#include "../loggers/delta_state_logger.hpp"
+
+using namespace std;
+
+using TIME = NDTime;
+
+static ostringstream log_text;
+
+struct bench_sink_provider{
+    static std::ostream& sink(){
+        return log_text;
+    }
+};
+
+struct state_record {
+    string time;
+    string model;
+    string state;
+};
+
+//Keeps the state events it sees, to compare the two runs
+struct state_recorder {
+    inline static vector<state_record> records;
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::sim_state>::value) {
+            record(params...);
+        }
+    }
+
+    static void record(const TIME& t, const string& model, const string& state) {
+        ostringstream time;
+        time << t;
+        records.push_back(state_record{time.str(), model, state});
+    }
+};
+
+using text_state=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<TIME>, bench_sink_provider>;
+using text_global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, bench_sink_provider>;
+using full_states=cadmium::logger::multilogger<text_state, text_global_time, state_recorder>;
+using delta_states=delta_state_logger<TIME, full_states>;
+
+template<typename LOGGER>
+vector<state_record> run(const char* name, const TIME& horizon) {
+    disco_top_config config;
+    config.lcd_output = "/dev/null";
+    config.seeded = true;
+    config.seed = 1;
+
+    log_text.str("");
+    state_recorder::records.clear();
+
+    auto TOP = make_disco_top<TIME>(config);
+    cadmium::dynamic::engine::runner<TIME, LOGGER> r(TOP, {0});
+    r.run_until(horizon);
+
+    cout << left << setw(8) << name << right
+         << setw(14) << state_recorder::records.size()
+         << setw(14) << log_text.str().size() << "\n";
+    return state_recorder::records;
+}
+
+//Applies both logs time by time; after each time every model must have the same state in both
+bool same_states(const vector<state_record>& full, const vector<state_record>& delta) {
+    map<string, string> full_state, delta_state;
+    size_t d = 0;
+    for (size_t f = 0; f < full.size(); ) {
+        const string& time = full[f].time;
+        for (; f < full.size() && full[f].time == time; f++) {
+            full_state[full[f].model] = full[f].state;
+        }
+        for (; d < delta.size() && delta[d].time == time; d++) {
+            delta_state[delta[d].model] = delta[d].state;
+        }
+        if (full_state != delta_state) {
+            cerr << "States differ at " << time << endl;
+            return false;
+        }
+    }
+    return d == delta.size();
+}
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "01:00:00:000");
+    delta_states::keyframe_period = TIME(argc > 2 ? argv[2] : "00:10:00:000");
+
+    cout << "Horizon: " << horizon << ", keyframe every " << delta_states::keyframe_period << "\n";
+    cout << left << setw(8) << "states" << right << setw(14) << "state lines" << setw(14) << "bytes" << "\n";
+
+    const vector<state_record> full = run<full_states>("full", horizon);
+    const size_t full_bytes = log_text.str().size();
+    const vector<state_record> delta = run<delta_states>("delta", horizon);
+    const size_t delta_bytes = log_text.str().size();
+
+    cout << fixed << setprecision(1)
+         << "Reduction: " << 100.0 * (1.0 - (double) delta.size() / full.size()) << "% of state lines, "
+         << 100.0 * (1.0 - (double) delta_bytes / full_bytes) << "% of bytes ("
+         << delta_states::unchanged() << " unchanged states left out)\n";
+
+    const bool ok = same_states(full, delta);
+    cout << "States rebuilt from the delta log match: " << (ok ? "yes" : "NO") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/**
+* ARSLab - Carleton University
+*
+* Tickless benchmark:
+* Runs DISCO_TOP on realtime_runner with virtual_clock, the host stand-in
+* for the target's tickless_clock, so a day of sleep/wake scheduling takes
+* well under a second. Reports how often the core would sleep, how much of
+* the time it would be asleep, and the wake-up lateness against
+* MISSED_DEADLINE_TOLERANCE. It also checks the schedule: one sleep per
+* distinct event time and every wake-up inside [latency, latency + jitter].
+*
+* Usage (from top_model/): BENCH_TICKLESS [HH:MM:SS:mmm] [latency us] [jitter us]
+*                          default 24:00:00:000 30 20
+*/
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#define MISSED_DEADLINE_TOLERANCE 1000000
+
+#include "../top_model/disco_top.hpp"
+#include "../engine/realtime_runner.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+//Counts distinct event times (one wake-up each; events at the same time run back to back)
+struct event_time_counter {
+    inline static unsigned long long times = 0;
+    inline static TIME last = TIME::infinity();
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::run_global_time>::value) {
+            const TIME& t = std::get<0>(std::tie(params...));
+            if (t != last) times++;
+            last = t;
+        }
+    }
+};
+
+int main(int argc, char ** argv) {
+    const TIME horizon(argc > 1 ? argv[1] : "24:00:00:000");
+    const long long latency_us = argc > 2 ? stoll(argv[2]) : 30;
+    const long long jitter_us = argc > 3 ? stoll(argv[3]) : 20;
+
+    disco_top_config config;
+    config.lcd_output = "/dev/null";
+    auto TOP = make_disco_top<TIME>(config);
+    realtime_runner<TIME, event_time_counter, virtual_clock> r(TOP, {0}, 1.0, MISSED_DEADLINE_TOLERANCE,
+                                                               latency_us, jitter_us);
+
+    auto start = hclock::now();
+    try {
+        r.run_until(horizon);
+    } catch (const missed_deadline& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+    const virtual_clock& clock = r.clock();
+    const log_histogram<>& lateness = r.wake_lateness();
+    const double virtual_seconds = clock.now_us() / 1e6;
+
+    cout << fixed
+         << "Horizon:        " << horizon << " (wake-up latency " << latency_us << " us + up to " << jitter_us << " us jitter)\n"
+         << "Wall time:      " << setprecision(3) << elapsed << " s\n"
+         << "Event times:    " << event_time_counter::times << "\n"
+         << "Sleeps:         " << clock.sleeps() << " (" << setprecision(2) << clock.sleeps() / virtual_seconds << " per second)\n"
+         << "Asleep:         " << setprecision(4) << 100.0 * clock.asleep_us() / clock.now_us() << " % of the run\n"
+         << "Wake lateness:  p50 " << lateness.percentile(0.5) << " us, p99 " << lateness.percentile(0.99)
+         << " us, p99.9 " << lateness.percentile(0.999) << " us, max " << lateness.max() << " us\n"
+         << "Tolerance:      " << MISSED_DEADLINE_TOLERANCE << " us (worst wake-up uses "
+         << setprecision(3) << 100.0 * lateness.max() / MISSED_DEADLINE_TOLERANCE << " %)\n";
+
+    //Every event gets its own sleep, and every wake-up is as late as the clock was told
+    bool ok = clock.sleeps() == event_time_counter::times && lateness.max() <= (uint64_t) (latency_us + jitter_us)
+              && lateness.percentile(0.0) >= (uint64_t) latency_us;
+    if (!ok) cerr << "Unexpected sleep/wake schedule" << endl;
+    return ok ? 0 : 1;
+}
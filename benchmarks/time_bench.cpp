@@ -0,0 +1,130 @@
+/**
+* ARSLab - Carleton University
+*
+* Time type benchmark:
+* Compares NDTime with micro_time (data_structures/fixed_time.hpp). First
+* the operations the atomics perform per event: building a time from text
+* (as Switch did for its debounce) and from a literal (to_time<TIME>(100_ms),
+* data_structures/time_literals.hpp), comparing and adding, and Switch's
+* whole transition on a touch. Then DISCO_TOP for the same horizon on each
+* type, without logging, as transitions/sec. Both TOPs must write the same
+* LCD output.
+*
+* Usage (from top_model/): BENCH_TIME [HH:MM:SS:mmm] [outputs]   default 24:00:00:000 ./outputs
+*/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../top_model/disco_top.hpp"
+#include "../data_structures/fixed_time.hpp"
+#include "../data_structures/time_literals.hpp"
+#include "../engine/transition_counter.hpp"
+
+using namespace std;
+using namespace time_literals;
+
+using hclock=chrono::high_resolution_clock;
+
+const long OPERATIONS = 1000000;
+
+//Nanoseconds per operation; the results feed sink so nothing is optimized away
+template<typename TIME, typename OPERATION>
+double time_operation(OPERATION operation) {
+    volatile long sink = 0;
+    auto start = hclock::now();
+    for (long i = 0; i < OPERATIONS; i++) {
+        sink = sink + operation(i);
+    }
+    return chrono::duration<double, nano>(hclock::now() - start).count() / OPERATIONS;
+}
+
+template<typename TIME>
+void run_operations(const char* name) {
+    const char* debounce[] = {"00:00:00:100", "00:00:00:200"};
+    const TIME step("00:00:01:000");
+    TIME now("00:00:00:000");
+
+    const time_constant literal[] = {100_ms, 200_ms};
+    const double parse = time_operation<TIME>([&](long i) { return TIME(debounce[i & 1]) == step; });
+    const double from_literal = time_operation<TIME>([&](long i) { return to_time<TIME>(literal[i & 1]) == step; });
+    const double compare = time_operation<TIME>([&](long i) { return (i & 1 ? step : now) > TIME::zero(); });
+    const double add = time_operation<TIME>([&](long) { now = now + step; return now < TIME::infinity(); });
+
+    //A press at the bottom of the screen, 1 s after the last: the switch changes sensor
+    Switch<TIME> sensor_switch;
+    using switch_inputs=typename make_message_bags<typename Switch<TIME>::input_ports>::type;
+    switch_inputs touch;
+    get_messages<switch_defs::ts_in>(touch).push_back(cartesian_coordinates{120, 300});
+    const double touch_event = time_operation<TIME>([&](long) {
+        sensor_switch.external_transition(step, touch);
+        return sensor_switch.state.sensor_idx;
+    });
+
+    cout << left << setw(12) << name << right << fixed << setprecision(1)
+         << setw(14) << parse << setw(14) << from_literal << setw(14) << compare << setw(14) << add << setw(14) << touch_event << "\n";
+}
+
+template<typename TIME>
+void run_top(const char* name, const char* horizon_text, const string& lcd_output) {
+    disco_top_config config;
+    config.lcd_output = lcd_output;
+    config.seeded = true;
+    config.seed = 1;
+
+    transition_counter::reset();
+    const TIME horizon(horizon_text);
+    {
+        auto TOP = make_disco_top<TIME, counted>(config);
+        cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger> r(TOP, {0});
+
+        auto start = hclock::now();
+        r.run_until(horizon);
+        const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+        cout << left << setw(12) << name << right
+             << setw(14) << transition_counter::total()
+             << setw(12) << fixed << setprecision(3) << elapsed
+             << setw(14) << setprecision(0) << transition_counter::total() / elapsed << "\n";
+    } //LCD file closed
+}
+
+string read_file(const string& path) {
+    ifstream in(path);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+int main(int argc, char ** argv) {
+    const char* horizon = argc > 1 ? argv[1] : "24:00:00:000";
+    const string outputs = argc > 2 ? argv[2] : "./outputs";
+
+    cout << left << setw(12) << "ns/op" << right << setw(14) << "from text" << setw(14) << "from literal" << setw(14) << "compare"
+         << setw(14) << "add" << setw(14) << "touch" << "\n";
+    run_operations<NDTime>("NDTime");
+    run_operations<micro_time>("micro_time");
+
+    cout << "\nHorizon: " << horizon << "\n";
+    cout << left << setw(12) << "TIME" << right << setw(14) << "transitions" << setw(12) << "wall (s)" << setw(14) << "events/s" << "\n";
+    run_top<NDTime>("NDTime", horizon, outputs + "/LCD_out_ndtime.txt");
+    run_top<micro_time>("micro_time", horizon, outputs + "/LCD_out_micro_time.txt");
+
+    const string expected = read_file(outputs + "/LCD_out_ndtime.txt");
+    if (expected.empty()) {
+        cerr << "No LCD output in " << outputs << " (does the directory exist?)" << endl;
+        return 1;
+    }
+    if (expected != read_file(outputs + "/LCD_out_micro_time.txt")) {
+        cerr << "micro_time wrote a different LCD_out.txt" << endl;
+        return 1;
+    }
+    cout << "LCD output identical\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+* ARSLab - Carleton University
+*
+* Block pool:
+* Recycles small heap blocks. Blocks of up to max_block bytes are taken
+* from one free list per 16-byte size class, refilled from malloc about
+* chunk bytes at a time; released blocks go back on their list instead of to
+* free. Once a run has been through its busiest event, every block it
+* needs is on a list, so the same events need no malloc at all. Larger
+* blocks, and all blocks while disabled, come from malloc as usual.
+*
+* Every block carries a 16-byte header holding its size class (0: from
+* malloc), so a block is released correctly whatever the pool's state when
+* it was allocated, and the size and tag it was allocated with (the
+* allocation profiler charges a block's release to its tag). The lists and
+* counts are per thread (one set on the board); a block released by another
+* thread joins that thread's lists. Refilled chunks are kept until the
+* program ends, so blocks that keep moving between threads (one allocating,
+* another freeing) make the pool grow without bound: pooled programs
+* allocate and free on one thread.
+*/
+
+#ifndef DISCO_BLOCK_POOL_HPP
+#define DISCO_BLOCK_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef RT_ARM_MBED
+#define DISCO_POOL_LOCAL
+#else
+#define DISCO_POOL_LOCAL thread_local
+#endif
+
+class block_pool {
+public:
+    static constexpr size_t granule = 16;
+    //Up to 1 KB: the state strings cadmium builds every transition fit
+    static constexpr size_t classes = 64;
+    static constexpr size_t max_block = granule * classes;
+    static constexpr size_t chunk = 4096;
+
+private:
+    struct alignas(16) header {
+        uint32_t size_class;
+        uint32_t tag;
+        uint64_t size;
+    };
+    static_assert(sizeof(header) == 16, "the header must keep payloads 16-byte aligned");
+
+    struct free_block {
+        free_block* next;
+    };
+
+    inline static DISCO_POOL_LOCAL free_block* _free[classes + 1] = {};
+
+    static bool fill(size_t size_class) {
+        const size_t block = sizeof(header) + size_class * granule;
+        const size_t count = chunk / block;
+        char* blocks = static_cast<char*>(malloc(block * count));
+        if (!blocks) return false;
+        heap_allocations++;
+        for (size_t i = 0; i < count; i++) {
+            free_block* b = reinterpret_cast<free_block*>(blocks + i * block + sizeof(header));
+            b->next = _free[size_class];
+            _free[size_class] = b;
+        }
+        return true;
+    }
+
+public:
+    //Off: every block comes from malloc (e.g. to measure the difference)
+    inline static bool enabled = true;
+
+    //Blocks allocated, the bytes asked for, and the mallocs behind them (refills included), on this thread
+    inline static DISCO_POOL_LOCAL unsigned long long allocations = 0;
+    inline static DISCO_POOL_LOCAL unsigned long long allocated_bytes = 0;
+    inline static DISCO_POOL_LOCAL unsigned long long heap_allocations = 0;
+
+    //nullptr if out of memory
+    static void* allocate(size_t size, uint32_t tag = 0) {
+        allocations++;
+        allocated_bytes += size;
+        const size_t size_class = size ? (size + granule - 1) / granule : 1;
+        if (enabled && size_class <= classes) {
+            if (!_free[size_class] && !fill(size_class)) return nullptr;
+            free_block* b = _free[size_class];
+            _free[size_class] = b->next;
+            header* h = reinterpret_cast<header*>(b) - 1;
+            h->size_class = (uint32_t) size_class;
+            h->tag = tag;
+            h->size = size;
+            return b;
+        }
+
+        header* h = static_cast<header*>(malloc(sizeof(header) + size));
+        if (!h) return nullptr;
+        heap_allocations++;
+        h->size_class = 0;
+        h->tag = tag;
+        h->size = size;
+        return h + 1;
+    }
+
+    //Of a block from allocate
+    static uint32_t tag_of(const void* p) {
+        return (static_cast<const header*>(p) - 1)->tag;
+    }
+
+    static size_t size_of(const void* p) {
+        return (size_t) (static_cast<const header*>(p) - 1)->size;
+    }
+
+    static void release(void* p) {
+        if (!p) return;
+        header* h = static_cast<header*>(p) - 1;
+        if (h->size_class == 0) {
+            free(h);
+            return;
+        }
+        free_block* b = static_cast<free_block*>(p);
+        b->next = _free[h->size_class];
+        _free[h->size_class] = b;
+    }
+};
+
+#endif // DISCO_BLOCK_POOL_HPP
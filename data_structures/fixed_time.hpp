@@ -0,0 +1,183 @@
+/**
+* ARSLab - Carleton University
+*
+* Fixed-point time:
+* Simulation time as one 64-bit count of TICK_NS nanosecond ticks, usable
+* wherever NDTime is: TIME(), TIME{h, m, s, ms...}, TIME("hh:mm:ss:mmm"),
+* zero(), infinity(), std::numeric_limits, comparisons, + and -, and the
+* same text form on streams. Comparing or adding times is one integer
+* operation instead of NDTime's multi-field arithmetic.
+*
+* micro_time (1 us ticks) spans about 292000 years, nano_time (1 ns ticks)
+* about 292 years; infinity is the largest count. Digits finer than a tick
+* are dropped when parsing.
+*/
+
+#ifndef DISCO_FIXED_TIME_HPP
+#define DISCO_FIXED_TIME_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+
+#ifndef RT_ARM_MBED
+#include <stdexcept>
+#endif
+
+#include "../engine/time_conversion.hpp"
+
+template<int64_t TICK_NS>
+class fixed_time {
+    static_assert(TICK_NS > 0 && 1000000000LL % TICK_NS == 0, "a tick must divide one second");
+
+    static constexpr int64_t INFINITE = std::numeric_limits<int64_t>::max();
+
+    //Nanoseconds per field of hh:mm:ss:mmm:uuu:nnn
+    static constexpr int64_t field_ns(int field) {
+        constexpr int64_t ns[] = {3600000000000LL, 60000000000LL, 1000000000LL, 1000000LL, 1000LL, 1LL};
+        return ns[field];
+    }
+
+    int64_t _ticks = 0;
+
+    static constexpr int64_t invalid(const char* text) {
+        #ifdef RT_ARM_MBED
+        return (void) text, INFINITE;
+        #else
+        throw std::invalid_argument(std::string("Not a time: ") + text);
+        #endif
+    }
+
+    static constexpr int64_t parse(const char* text) {
+        if (text[0] == 'i' && text[1] == 'n' && text[2] == 'f' && text[3] == '\0') return INFINITE;
+
+        int64_t ns = 0;
+        int64_t value = 0;
+        int field = 0;
+        bool digits = false;
+        for (const char* c = text; ; c++) {
+            if (*c >= '0' && *c <= '9') {
+                value = value * 10 + (*c - '0');
+                digits = true;
+            } else if ((*c == ':' || *c == '\0') && digits && field < 6) {
+                ns += value * field_ns(field++);
+                value = 0;
+                digits = false;
+                if (*c == '\0') break;
+            } else {
+                return invalid(text);
+            }
+        }
+        return ns / TICK_NS;
+    }
+
+    static constexpr fixed_time from_ticks_unchecked(int64_t ticks) {
+        fixed_time t;
+        t._ticks = ticks;
+        return t;
+    }
+
+public:
+    constexpr fixed_time() = default;
+
+    //{hours, minutes, seconds, milliseconds, microseconds, nanoseconds}, trailing fields optional
+    constexpr fixed_time(std::initializer_list<int64_t> fields) {
+        int64_t ns = 0;
+        int field = 0;
+        for (int64_t value : fields) {
+            if (field < 6) ns += value * field_ns(field++);
+        }
+        _ticks = ns / TICK_NS;
+    }
+
+    constexpr fixed_time(const char* text) : _ticks(parse(text)) {}
+    fixed_time(const std::string& text) : _ticks(parse(text.c_str())) {}
+
+    static constexpr fixed_time from_ticks(int64_t ticks) { return from_ticks_unchecked(ticks); }
+    constexpr int64_t ticks() const { return _ticks; }
+
+    static constexpr fixed_time zero() { return fixed_time(); }
+    static constexpr fixed_time infinity() { return from_ticks_unchecked(INFINITE); }
+
+    //Infinity absorbs any finite time
+    friend constexpr fixed_time operator+(const fixed_time& a, const fixed_time& b) {
+        return (a._ticks == INFINITE || b._ticks == INFINITE) ? infinity() : from_ticks_unchecked(a._ticks + b._ticks);
+    }
+    friend constexpr fixed_time operator-(const fixed_time& a, const fixed_time& b) {
+        return a._ticks == INFINITE ? infinity() : from_ticks_unchecked(a._ticks - b._ticks);
+    }
+    fixed_time& operator+=(const fixed_time& b) { return *this = *this + b; }
+    fixed_time& operator-=(const fixed_time& b) { return *this = *this - b; }
+
+    friend constexpr bool operator==(const fixed_time& a, const fixed_time& b) { return a._ticks == b._ticks; }
+    friend constexpr bool operator!=(const fixed_time& a, const fixed_time& b) { return a._ticks != b._ticks; }
+    friend constexpr bool operator<(const fixed_time& a, const fixed_time& b) { return a._ticks < b._ticks; }
+    friend constexpr bool operator>(const fixed_time& a, const fixed_time& b) { return a._ticks > b._ticks; }
+    friend constexpr bool operator<=(const fixed_time& a, const fixed_time& b) { return a._ticks <= b._ticks; }
+    friend constexpr bool operator>=(const fixed_time& a, const fixed_time& b) { return a._ticks >= b._ticks; }
+
+    //hh:mm:ss:mmm, with :uuu:nnn when there is more than whole milliseconds (as NDTime prints)
+    friend std::ostream& operator<<(std::ostream& os, const fixed_time& t) {
+        if (t._ticks == INFINITE) return os << "inf";
+
+        const int64_t ns = t._ticks * TICK_NS;
+        char text[48];
+        int len = snprintf(text, sizeof(text), "%02lld:%02lld:%02lld:%03lld", (long long) (ns / 3600000000000LL),
+                           (long long) (ns / 60000000000LL % 60), (long long) (ns / 1000000000LL % 60),
+                           (long long) (ns / 1000000 % 1000));
+        if (ns % 1000000) {
+            snprintf(text + len, sizeof(text) - len, ":%03lld:%03lld", (long long) (ns / 1000 % 1000), (long long) (ns % 1000));
+        }
+        return os << text;
+    }
+
+    friend std::istream& operator>>(std::istream& is, fixed_time& t) {
+        std::string text;
+        if (is >> text) t = fixed_time(text);
+        return is;
+    }
+};
+
+using micro_time = fixed_time<1000>;
+using nano_time = fixed_time<1>;
+
+namespace std {
+    template<int64_t TICK_NS>
+    class numeric_limits<fixed_time<TICK_NS>> {
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool has_infinity = true;
+        static constexpr fixed_time<TICK_NS> infinity() { return fixed_time<TICK_NS>::infinity(); }
+        static constexpr fixed_time<TICK_NS> max() { return fixed_time<TICK_NS>::from_ticks(std::numeric_limits<int64_t>::max() - 1); }
+        static constexpr fixed_time<TICK_NS> min() { return fixed_time<TICK_NS>::zero(); }
+        static constexpr fixed_time<TICK_NS> lowest() { return fixed_time<TICK_NS>::zero(); }
+    };
+}
+
+//No text round trip: the tick count is the time
+template<int64_t TICK_NS>
+struct time_conversion<fixed_time<TICK_NS>> {
+
+    static constexpr int64_t infinity = std::numeric_limits<int64_t>::max();
+
+    static int64_t to_nanoseconds(const fixed_time<TICK_NS>& t, int* fields = nullptr) {
+        if (t == fixed_time<TICK_NS>::infinity()) return infinity;
+        const int64_t ns = t.ticks() * TICK_NS;
+        if (fields) *fields = (ns % 1000000) ? 6 : 4;
+        return ns;
+    }
+
+    static int64_t count_nanoseconds(const fixed_time<TICK_NS>& t) {
+        return to_nanoseconds(t);
+    }
+
+    static fixed_time<TICK_NS> from_nanoseconds(int64_t ns, int = 4) {
+        return ns == infinity ? fixed_time<TICK_NS>::infinity() : fixed_time<TICK_NS>::from_ticks(ns / TICK_NS);
+    }
+};
+
+#endif // DISCO_FIXED_TIME_HPP
@@ -0,0 +1,95 @@
+/**
+* ARSLab - Carleton University
+*
+* Log histogram:
+* HDR-style histogram of non-negative integers in constant memory. Values
+* below 2 * SUB_BUCKETS are counted exactly; above that every power of two
+* is split into SUB_BUCKETS linear buckets, so any recorded value is off by
+* at most 1 / SUB_BUCKETS (6% with the default 16). Values of 2^MAX_BITS and
+* more share the last bucket; max() is always exact.
+*/
+
+#ifndef DISCO_LOG_HISTOGRAM_HPP
+#define DISCO_LOG_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstring>
+
+template<int SUB_BITS = 4, int MAX_BITS = 36>
+class log_histogram {
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BITS;
+    static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * (int) SUB_BUCKETS;
+
+    uint32_t _counts[BUCKETS];
+    uint64_t _total;
+    uint64_t _max;
+
+    static int bucket_of(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) return (int) value;
+
+        int msb = 63;
+        while (!(value >> msb)) msb--;
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+
+        const int shift = msb - SUB_BITS;
+        return (shift + 1) * (int) SUB_BUCKETS + (int) ((value >> shift) - SUB_BUCKETS);
+    }
+
+    //Largest value counted in bucket
+    static uint64_t bucket_top(int bucket) {
+        if (bucket < (int) (2 * SUB_BUCKETS)) return (uint64_t) bucket;
+
+        const int shift = bucket / (int) SUB_BUCKETS - 1;
+        const uint64_t sub = (uint64_t) bucket % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+public:
+    log_histogram() {
+        reset();
+    }
+
+    void reset() {
+        memset(_counts, 0, sizeof(_counts));
+        _total = 0;
+        _max = 0;
+    }
+
+    void record(uint64_t value) {
+        _counts[bucket_of(value)]++;
+        _total++;
+        if (value > _max) _max = value;
+    }
+
+    uint64_t count() const { return _total; }
+    uint64_t max() const { return _max; }
+
+    //Smallest bucket bound with at least fraction (0..1) of the values at or below it
+    uint64_t percentile(double fraction) const {
+        if (_total == 0) return 0;
+
+        uint64_t rank = (uint64_t) (fraction * _total + 0.5);
+        if (rank < 1) rank = 1;
+
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < BUCKETS; bucket++) {
+            seen += _counts[bucket];
+            if (seen >= rank) {
+                const uint64_t top = bucket_top(bucket);
+                return top < _max ? top : _max;
+            }
+        }
+        return _max;
+    }
+
+    log_histogram& operator+=(const log_histogram& other) {
+        for (int bucket = 0; bucket < BUCKETS; bucket++) {
+            _counts[bucket] += other._counts[bucket];
+        }
+        _total += other._total;
+        if (other._max > _max) _max = other._max;
+        return *this;
+    }
+};
+
+#endif // DISCO_LOG_HISTOGRAM_HPP
@@ -0,0 +1,58 @@
+/**
+* ARSLab - Carleton University
+*
+* Message views:
+* get_messages hands an atomic the vector its bag holds; assigning that to
+* a local (const auto x = get_messages<...>(mbs)) copies every message and
+* the vector's buffer. messages_in<PORT>(mbs) returns a read-only view of
+* the same messages instead, valid while mbs is. On the way out,
+* emplace_message<PORT>(bags, args...) builds the message in its bag and
+* move_message<PORT>(bags, m) moves a message in.
+*/
+
+#ifndef DISCO_MESSAGE_VIEW_HPP
+#define DISCO_MESSAGE_VIEW_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <cadmium/modeling/message_bag.hpp>
+
+template<typename T>
+class message_view {
+    const T* _first;
+    size_t _size;
+
+public:
+    using value_type=T;
+    using const_iterator=const T*;
+
+    explicit message_view(const std::vector<T>& messages) : _first(messages.data()), _size(messages.size()) {}
+
+    const T* begin() const { return _first; }
+    const T* end() const { return _first + _size; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const T& operator[](size_t i) const { return _first[i]; }
+    const T& front() const { return _first[0]; }
+    const T& back() const { return _first[_size - 1]; }
+};
+
+template<typename PORT, typename BAGS>
+message_view<typename PORT::message_type> messages_in(const BAGS& mbs) {
+    return message_view<typename PORT::message_type>(cadmium::get_messages<PORT>(mbs));
+}
+
+template<typename PORT, typename BAGS, typename... ARGS>
+void emplace_message(BAGS& bags, ARGS&&... args) {
+    cadmium::get_messages<PORT>(bags).emplace_back(std::forward<ARGS>(args)...);
+}
+
+template<typename PORT, typename BAGS>
+void move_message(BAGS& bags, typename PORT::message_type&& message) {
+    cadmium::get_messages<PORT>(bags).push_back(std::move(message));
+}
+
+#endif // DISCO_MESSAGE_VIEW_HPP
@@ -0,0 +1,84 @@
+/**
+* ARSLab - Carleton University
+*
+* Single-producer / single-consumer byte ring:
+* Lock free; one thread writes, another reads. Capacity is rounded up to
+* a power of two and never grows, so memory use is bounded.
+*/
+
+#ifndef DISCO_SPSC_RING_HPP
+#define DISCO_SPSC_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+class spsc_ring {
+    std::unique_ptr<char[]> _buffer;
+    size_t _capacity;
+    size_t _mask;
+
+    //Kept on separate cache lines so producer and consumer do not contend
+    alignas(64) std::atomic<size_t> _head; // next byte to write (producer)
+    alignas(64) std::atomic<size_t> _tail; // next byte to read (consumer)
+
+    static size_t round_up(size_t n) {
+        size_t capacity = 1;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+public:
+    explicit spsc_ring(size_t capacity) :
+        _buffer(new char[round_up(capacity)]),
+        _capacity(round_up(capacity)),
+        _mask(round_up(capacity) - 1),
+        _head(0),
+        _tail(0) {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    //Bytes waiting to be read
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    //Producer: copies as much of data as fits, returns the bytes copied
+    size_t write(const char* data, size_t size) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        const size_t n = std::min(size, _capacity - (head - tail));
+
+        const size_t offset = head & _mask;
+        const size_t first = std::min(n, _capacity - offset);
+        memcpy(_buffer.get() + offset, data, first);
+        memcpy(_buffer.get(), data + first, n - first);
+
+        _head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    //Consumer: copies up to size bytes out, returns the bytes copied
+    size_t read(char* data, size_t size) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t n = std::min(size, head - tail);
+
+        const size_t offset = tail & _mask;
+        const size_t first = std::min(n, _capacity - offset);
+        memcpy(data, _buffer.get() + offset, first);
+        memcpy(data + first, _buffer.get(), n - first);
+
+        _tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+};
+
+#endif // DISCO_SPSC_RING_HPP
@@ -0,0 +1,49 @@
+/**
+* ARSLab - Carleton University
+*
+* Time literals:
+* Durations written as 100_ms, 1_s, 30_min... are constexpr nanosecond
+* counts (time_constant), and to_time<TIME>(100_ms) makes them a TIME from
+* their fields, {h, m, s, ms} (or {h, m, s, ms, us, ns} below a
+* millisecond), without going through text. With micro_time the whole
+* conversion happens at compile time; with NDTime it is a constructor call,
+* so keep the result (e.g. in a static member) when it is needed per event.
+*/
+
+#ifndef DISCO_TIME_LITERALS_HPP
+#define DISCO_TIME_LITERALS_HPP
+
+#include <cstdint>
+
+struct time_constant {
+    int64_t ns;
+
+    constexpr int64_t hours() const { return ns / 3600000000000LL; }
+    constexpr int64_t minutes() const { return ns / 60000000000LL % 60; }
+    constexpr int64_t seconds() const { return ns / 1000000000LL % 60; }
+    constexpr int64_t milliseconds() const { return ns / 1000000 % 1000; }
+    constexpr int64_t microseconds() const { return ns / 1000 % 1000; }
+    constexpr int64_t nanoseconds() const { return ns % 1000; }
+};
+
+constexpr time_constant operator+(time_constant a, time_constant b) { return {a.ns + b.ns}; }
+constexpr time_constant operator*(time_constant a, int64_t n) { return {a.ns * n}; }
+
+namespace time_literals {
+    constexpr time_constant operator""_h(unsigned long long n) { return {(int64_t) n * 3600000000000LL}; }
+    constexpr time_constant operator""_min(unsigned long long n) { return {(int64_t) n * 60000000000LL}; }
+    constexpr time_constant operator""_s(unsigned long long n) { return {(int64_t) n * 1000000000LL}; }
+    constexpr time_constant operator""_ms(unsigned long long n) { return {(int64_t) n * 1000000LL}; }
+    constexpr time_constant operator""_us(unsigned long long n) { return {(int64_t) n * 1000LL}; }
+    constexpr time_constant operator""_ns(unsigned long long n) { return {(int64_t) n}; }
+}
+
+template<typename TIME>
+constexpr TIME to_time(time_constant t) {
+    if (t.ns % 1000000 == 0) {
+        return TIME{(int) t.hours(), (int) t.minutes(), (int) t.seconds(), (int) t.milliseconds()};
+    }
+    return TIME{(int) t.hours(), (int) t.minutes(), (int) t.seconds(), (int) t.milliseconds(), (int) t.microseconds(), (int) t.nanoseconds()};
+}
+
+#endif // DISCO_TIME_LITERALS_HPP
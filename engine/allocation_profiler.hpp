@@ -0,0 +1,317 @@
+/**
+* ARSLab - Carleton University
+*
+* Allocation profiler:
+* Decorates an atomic model so the heap allocations made during its
+* transitions and outputs are charged to it, and to a message type: its
+* output ports' message types for output, "(state)" for transitions and
+* time_advance. Allocations made anywhere else (the engine routing bags,
+* loggers) go to "(engine)". allocation_report::print lists, per model and
+* per message type, the allocations and bytes per simulated second and the
+* peak of the bytes they had live. Build with -DDISCO_ALLOC_PROFILE to
+* enable it. Otherwise alloc_profiled<ATOMIC> is ATOMIC itself and the
+* report prints nothing.
+*
+* On the host every block is tagged with the scope that allocated it
+* (engine/pooled_allocation.hpp), so a release is charged to the block's
+* owner wherever it happens. On the board the operator new hooks are not
+* used: each call is measured by mbed's heap statistics
+* (platform.heap-stats-enabled in mbed_app.json), so live bytes are the
+* net change over the model's own calls. Counts are not synchronized:
+* profile runs on one thread.
+*/
+
+#ifndef DISCO_ALLOCATION_PROFILER_HPP
+#define DISCO_ALLOCATION_PROFILER_HPP
+
+#include <iostream>
+
+#ifdef DISCO_ALLOC_PROFILE
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+
+#ifdef RT_ARM_MBED
+#include "../mbed.h"
+#if !MBED_HEAP_STATS_ENABLED
+#error "DISCO_ALLOC_PROFILE on the board needs platform.heap-stats-enabled (mbed_app.json)"
+#endif
+#else
+#include <cxxabi.h>
+#endif
+
+#include "model_scope.hpp"
+
+using namespace cadmium;
+
+#ifndef DISCO_ALLOC_PROFILE_MAX_MODELS
+#define DISCO_ALLOC_PROFILE_MAX_MODELS 16
+#endif
+
+#ifndef DISCO_ALLOC_PROFILE_MAX_MESSAGES
+#define DISCO_ALLOC_PROFILE_MAX_MESSAGES 16
+#endif
+
+struct allocation_profile {
+    unsigned long long allocations = 0;
+    unsigned long long bytes = 0;
+    long long live = 0;
+    long long peak = 0;
+
+    void allocated(unsigned long long count, unsigned long long size) {
+        allocations += count;
+        bytes += size;
+    }
+
+    void changed(long long size) {
+        live += size;
+        if (live > peak) peak = live;
+    }
+};
+
+class allocation_report {
+    static_assert(DISCO_ALLOC_PROFILE_MAX_MODELS >= 3, "model rows are needed for (engine), a model and (others)");
+    static_assert(DISCO_ALLOC_PROFILE_MAX_MESSAGES >= 4, "message rows are needed for (engine), (state), a message type and (others)");
+
+    struct entry {
+        char name[32];
+        allocation_profile profile;
+    };
+
+    //Row 0 of both tables is (engine); message row 1 is (state)
+    inline static entry _models[DISCO_ALLOC_PROFILE_MAX_MODELS] = {{"(engine)", {}}};
+    inline static entry _messages[DISCO_ALLOC_PROFILE_MAX_MESSAGES] = {{"(engine)", {}}, {"(state)", {}}};
+    inline static int _used_models = 1;
+    inline static int _used_messages = 2;
+
+    static uint32_t add(entry* entries, int& used, const char* name) {
+        entry& e = entries[used];
+        strncpy(e.name, name, sizeof(e.name) - 1);
+        e.name[sizeof(e.name) - 1] = '\0';
+        e.profile = allocation_profile();
+        return (uint32_t) used++;
+    }
+
+    //Row named name, added if new; once all rows but the last are taken, further names share the last, (others)
+    static uint32_t row_for(entry* entries, int& used, int max, const char* name) {
+        for (int i = 0; i < used; i++) {
+            if (strncmp(entries[i].name, name, sizeof(entries[i].name) - 1) == 0) return (uint32_t) i;
+        }
+        if (used < max - 1) return add(entries, used, name);
+        if (used == max - 1) add(entries, used, "(others)");
+        return (uint32_t) max - 1;
+    }
+
+    static void print_table(std::ostream& os, const char* title, entry* entries, int used, double seconds) {
+        entry* rows[DISCO_ALLOC_PROFILE_MAX_MODELS > DISCO_ALLOC_PROFILE_MAX_MESSAGES ? DISCO_ALLOC_PROFILE_MAX_MODELS : DISCO_ALLOC_PROFILE_MAX_MESSAGES];
+        int used_rows = 0;
+        for (int i = 0; i < used; i++) {
+            if (entries[i].profile.allocations) rows[used_rows++] = &entries[i];
+        }
+        std::sort(rows, rows + used_rows, [](const entry* a, const entry* b) {
+            return a->profile.bytes > b->profile.bytes;
+        });
+
+        os << std::left << std::setw(32) << title << std::right << std::setw(14) << "allocations" << std::setw(14) << "bytes"
+           << std::setw(12) << "allocs/s" << std::setw(14) << "bytes/s" << std::setw(12) << "peak live" << "\n";
+        for (int i = 0; i < used_rows; i++) {
+            const allocation_profile& profile = rows[i]->profile;
+            os << std::left << std::setw(32) << rows[i]->name << std::right
+               << std::setw(14) << profile.allocations << std::setw(14) << profile.bytes
+               << std::setw(12) << std::setprecision(1) << (seconds > 0 ? profile.allocations / seconds : 0.0)
+               << std::setw(14) << std::setprecision(0) << (seconds > 0 ? profile.bytes / seconds : 0.0)
+               << std::setw(12) << profile.peak << "\n";
+        }
+    }
+
+public:
+    //A tag names a model row (high 16 bits) and a message row (low 16 bits); 0 is the engine
+    static uint32_t tag_for(const char* model, const char* message) {
+        return row_for(_models, _used_models, DISCO_ALLOC_PROFILE_MAX_MODELS, model) << 16
+               | row_for(_messages, _used_messages, DISCO_ALLOC_PROFILE_MAX_MESSAGES, message);
+    }
+
+    static uint32_t state_tag(uint32_t tag) {
+        return (tag & 0xFFFF0000u) | 1u;
+    }
+
+    //count allocations of size bytes in all, live changing by live bytes
+    static void charge(uint32_t tag, unsigned long long count, unsigned long long size, long long live) {
+        entry& model = _models[tag >> 16];
+        entry& message = _messages[tag & 0xFFFFu];
+        model.profile.allocated(count, size);
+        message.profile.allocated(count, size);
+        model.profile.changed(live);
+        message.profile.changed(live);
+    }
+
+    static void release(uint32_t tag, unsigned long long size) {
+        _models[tag >> 16].profile.changed(-(long long) size);
+        _messages[tag & 0xFFFFu].profile.changed(-(long long) size);
+    }
+
+    static void reset() {
+        for (int i = 0; i < _used_models; i++) _models[i].profile = allocation_profile();
+        for (int i = 0; i < _used_messages; i++) _messages[i].profile = allocation_profile();
+    }
+
+    //Tables per model and per message type, by bytes; seconds is the simulated time profiled
+    static void print(std::ostream& os, double seconds) {
+        const std::ios_base::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+
+        os << std::fixed;
+        print_table(os, "Allocations by model", _models, _used_models, seconds);
+        print_table(os, "Allocations by message type", _messages, _used_messages, seconds);
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+};
+
+//The tag allocations on this thread are charged to
+class allocation_scope {
+    inline static thread_local uint32_t _current = 0;
+    uint32_t _previous;
+
+public:
+    explicit allocation_scope(uint32_t tag) : _previous(_current) {
+        _current = tag;
+        #ifdef RT_ARM_MBED
+        mbed_stats_heap_get(&_start);
+        #endif
+    }
+
+    ~allocation_scope() {
+        #ifdef RT_ARM_MBED
+        mbed_stats_heap_t end;
+        mbed_stats_heap_get(&end);
+        allocation_report::charge(_current, end.alloc_cnt - _start.alloc_cnt, end.total_size - _start.total_size,
+                                  (long long) end.current_size - (long long) _start.current_size);
+        #endif
+        _current = _previous;
+    }
+
+    allocation_scope(const allocation_scope&) = delete;
+    allocation_scope& operator=(const allocation_scope&) = delete;
+
+    static uint32_t current() {
+        return _current;
+    }
+
+private:
+    #ifdef RT_ARM_MBED
+    mbed_stats_heap_t _start;
+    #endif
+};
+
+//Names of the message types of PORTS, comma separated ("(none)" without ports)
+template<typename PORTS>
+struct port_message_names;
+
+template<typename... PORTS>
+struct port_message_names<std::tuple<PORTS...>> {
+    static void append(char* names, size_t size, const std::type_info& type) {
+        const char* name = type.name();
+        #ifndef RT_ARM_MBED
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0) name = demangled;
+        #endif
+        if (!strstr(names, name)) {
+            if (names[0]) strncat(names, ", ", size - strlen(names) - 1);
+            strncat(names, name, size - strlen(names) - 1);
+        }
+        #ifndef RT_ARM_MBED
+        free(demangled);
+        #endif
+    }
+
+    static void write(char* names, size_t size) {
+        names[0] = '\0';
+        (append(names, size, typeid(typename PORTS::message_type)), ...);
+        if (!names[0]) strncpy(names, "(none)", size);
+    }
+};
+
+/*
+* Usage: alloc_profiled<Arbiter>::model, built inside a model_scope naming
+* it (make_disco_top does this for every atomic).
+*/
+template<template<typename> class ATOMIC>
+struct alloc_profiled {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+        using output_bags=typename make_message_bags<typename base::output_ports>::type;
+
+        uint32_t _output_tag;
+        uint32_t _state_tag;
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...) {
+            char messages[32];
+            port_message_names<typename base::output_ports>::write(messages, sizeof(messages));
+            _output_tag = allocation_report::tag_for(model_scope::current(), messages);
+            _state_tag = allocation_report::state_tag(_output_tag);
+        }
+
+        // internal transition
+        void internal_transition() {
+            allocation_scope scope(_state_tag);
+            base::internal_transition();
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            allocation_scope scope(_state_tag);
+            base::external_transition(e, std::move(mbs));
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            allocation_scope scope(_state_tag);
+            base::confluence_transition(e, std::move(mbs));
+        }
+
+        // output function
+        output_bags output() const {
+            allocation_scope scope(_output_tag);
+            return base::output();
+        }
+
+        // time_advance function
+        TIME time_advance() const {
+            allocation_scope scope(_state_tag);
+            return base::time_advance();
+        }
+    };
+};
+
+#else
+
+//Allocation profiling disabled: the atomic itself, and an empty report
+template<template<typename> class ATOMIC>
+struct alloc_profiled {
+    template<typename TIME>
+    using model = ATOMIC<TIME>;
+};
+
+struct allocation_report {
+    static void reset() {}
+    static void print(std::ostream&, double) {}
+};
+
+#endif // DISCO_ALLOC_PROFILE
+
+#endif // DISCO_ALLOCATION_PROFILER_HPP
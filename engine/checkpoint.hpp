@@ -0,0 +1,340 @@
+/**
+* ARSLab - Carleton University
+*
+* Checkpoints:
+* Decorate every atomic with checkpointed, and save_checkpoint writes the
+* state of a running TOP at a time T to a compact binary snapshot. It holds,
+* per model, the last and next event times and the state. restore_checkpoint
+* loads the snapshot into a freshly built TOP. A runner started at T then
+* continues exactly where the saved run left off.
+*
+* Snapshot layout (little endian as written by the host):
+*   "DCKP" version:u8 time:t models:u32
+*   per model: id:str last:t next:t internal_transitions:u64 state:str
+* where t is ns:i64 fields:u8 (see time_conversion) and str is size:u32 bytes.
+* internal_transitions is 0 unless the model is restored by replaying them,
+* so equal states give equal snapshots however long the run.
+*
+* How a model's state is saved is chosen by checkpoint_state<ATOMIC>. By
+* default state_type is copied byte for byte; models whose state is not
+* trivially copyable need a specialization (see top_model/disco_checkpoint.hpp).
+*/
+
+#ifndef DISCO_CHECKPOINT_HPP
+#define DISCO_CHECKPOINT_HPP
+
+#include <cadmium.h>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "time_conversion.hpp"
+
+class checkpoint_writer {
+    std::ostream& _os;
+
+public:
+    explicit checkpoint_writer(std::ostream& os) : _os(os) {}
+
+    template<typename T>
+    void pod(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be written as bytes");
+        _os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void text(const std::string& value) {
+        pod((uint32_t) value.size());
+        _os.write(value.data(), value.size());
+    }
+
+    template<typename TIME>
+    void time(const TIME& t) {
+        int fields = 4;
+        pod(time_conversion<TIME>::to_nanoseconds(t, &fields));
+        pod((uint8_t) fields);
+    }
+};
+
+class checkpoint_reader {
+    std::istream& _is;
+
+    void check() {
+        if (!_is) throw std::runtime_error("Truncated or unreadable checkpoint");
+    }
+
+public:
+    explicit checkpoint_reader(std::istream& is) : _is(is) {}
+
+    template<typename T>
+    void pod(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be read as bytes");
+        _is.read(reinterpret_cast<char*>(&value), sizeof(T));
+        check();
+    }
+
+    std::string text() {
+        uint32_t size = 0;
+        pod(size);
+        std::string value(size, '\0');
+        _is.read(&value[0], size);
+        check();
+        return value;
+    }
+
+    template<typename TIME>
+    TIME time() {
+        int64_t ns = 0;
+        uint8_t fields = 0;
+        pod(ns);
+        pod(fields);
+        return time_conversion<TIME>::from_nanoseconds(ns, fields);
+    }
+};
+
+//What the checkpointed decorator knows about a model besides its state
+template<typename TIME>
+struct model_history {
+    TIME last;                                  //time of the last transition
+    unsigned long long internal_transitions;    //internal and confluence transitions so far
+};
+
+template<template<typename> class ATOMIC>
+struct checkpoint_state {
+    template<typename TIME>
+    static void save(const ATOMIC<TIME>& model, const model_history<TIME>&, checkpoint_writer& out) {
+        static_assert(std::is_trivially_copyable<typename ATOMIC<TIME>::state_type>::value,
+                      "state_type is not trivially copyable: specialize checkpoint_state for this model");
+        out.pod(model.state);
+    }
+
+    template<typename TIME>
+    static void restore(ATOMIC<TIME>& model, const model_history<TIME>&, checkpoint_reader& in) {
+        in.pod(model.state);
+    }
+};
+
+/*
+* For input models whose state cannot be reached (e.g. cadmium's
+* iestream_input): nothing is saved; a fresh model is brought to the saved
+* position by replaying its internal transitions.
+*/
+template<template<typename> class ATOMIC>
+struct replay_internal_transitions {
+    static constexpr bool replays = true;
+
+    template<typename TIME>
+    static void save(const ATOMIC<TIME>&, const model_history<TIME>&, checkpoint_writer&) {}
+
+    template<typename TIME>
+    static void restore(ATOMIC<TIME>& model, const model_history<TIME>& history, checkpoint_reader&) {
+        for (unsigned long long i = 0; i < history.internal_transitions; i++) {
+            model.internal_transition();
+        }
+    }
+};
+
+//Whether a checkpoint_state restores by replaying internal transitions, so their count is saved
+template<typename STATE, typename = void>
+struct replays_transitions : std::false_type {};
+
+template<typename STATE>
+struct replays_transitions<STATE, std::void_t<decltype(STATE::replays)>> : std::integral_constant<bool, STATE::replays> {};
+
+template<typename TIME>
+class checkpointable {
+public:
+    virtual ~checkpointable() = default;
+    virtual void save(checkpoint_writer& out) const = 0;
+    virtual void restore(checkpoint_reader& in, const TIME& resume_time) = 0;
+};
+
+/*
+* Usage: checkpointed<Switch>::model. It must wrap the atomic directly, so
+* apply it innermost: stacked<counted, checkpointed>.
+*
+* After a restore at T the engine starts the model at T. The first
+* time_advance then returns what was left of the saved one, and the first
+* elapsed time gets T - last added, so the model sees the uninterrupted
+* schedule.
+*/
+template<template<typename> class ATOMIC>
+struct checkpointed {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME>, public checkpointable<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+
+        TIME _last;
+        TIME _next;
+        unsigned long long _internal_transitions = 0;
+
+        bool _resumed = false;
+        TIME _remaining;    //time advance right after a restore
+        TIME _offset;       //added to the first elapsed time after a restore
+
+        TIME elapsed(TIME e) {
+            if (_resumed) {
+                e = e + _offset;
+                _resumed = false;
+            }
+            return e;
+        }
+
+        void schedule() {
+            _next = _last + base::time_advance();
+        }
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...) {
+            _last = TIME();
+            schedule();
+        }
+
+        // internal transition
+        void internal_transition() {
+            _resumed = false;
+            _last = _next;
+            _internal_transitions++;
+            base::internal_transition();
+            schedule();
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            e = elapsed(e);
+            _last = _last + e;
+            base::external_transition(e, std::move(mbs));
+            schedule();
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            e = elapsed(e);
+            _last = _next;
+            _internal_transitions++;
+            base::confluence_transition(e, std::move(mbs));
+            schedule();
+        }
+
+        // time_advance function
+        TIME time_advance() const {
+            return _resumed ? _remaining : base::time_advance();
+        }
+
+        void save(checkpoint_writer& out) const override {
+            out.time(_last);
+            out.time(_next);
+            out.pod((uint64_t) (replays_transitions<checkpoint_state<ATOMIC>>::value ? _internal_transitions : 0));
+
+            std::ostringstream state;
+            checkpoint_writer state_out(state);
+            checkpoint_state<ATOMIC>::save(static_cast<const base&>(*this), model_history<TIME>{_last, _internal_transitions}, state_out);
+            out.text(state.str());
+        }
+
+        void restore(checkpoint_reader& in, const TIME& resume_time) override {
+            _last = in.time<TIME>();
+            _next = in.time<TIME>();
+            uint64_t internal_transitions = 0;
+            in.pod(internal_transitions);
+            _internal_transitions = internal_transitions;
+
+            std::istringstream state(in.text());
+            checkpoint_reader state_in(state);
+            checkpoint_state<ATOMIC>::restore(static_cast<base&>(*this), model_history<TIME>{_last, _internal_transitions}, state_in);
+
+            _resumed = true;
+            _remaining = (_next == TIME::infinity()) ? TIME::infinity() : _next - resume_time;
+            _offset = resume_time - _last;
+        }
+    };
+};
+
+namespace checkpoint_detail {
+    template<typename TIME>
+    void collect(const std::shared_ptr<cadmium::dynamic::modeling::model>& model,
+                 std::map<std::string, checkpointable<TIME>*>& models) {
+        auto coupled = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(model);
+        if (coupled) {
+            for (const auto& submodel : coupled->_models) {
+                collect<TIME>(submodel, models);
+            }
+            return;
+        }
+        auto atomic = dynamic_cast<checkpointable<TIME>*>(model.get());
+        if (!atomic) {
+            throw std::logic_error("Model " + model->get_id() + " is not checkpointed");
+        }
+        models[model->get_id()] = atomic;
+    }
+
+    const char magic[4] = {'D', 'C', 'K', 'P'};
+    const uint8_t version = 1;
+}
+
+/*
+* Saves every atomic of top (all decorated with checkpointed) at time,
+* which must lie between the last and next events of the run, i.e. right
+* after runner.run_until(time).
+*/
+template<typename TIME>
+void save_checkpoint(std::ostream& os, const std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>& top, const TIME& time) {
+    std::map<std::string, checkpointable<TIME>*> models;
+    checkpoint_detail::collect<TIME>(top, models);
+
+    checkpoint_writer out(os);
+    os.write(checkpoint_detail::magic, sizeof(checkpoint_detail::magic));
+    out.pod(checkpoint_detail::version);
+    out.time(time);
+    out.pod((uint32_t) models.size());
+    for (const auto& model : models) {
+        out.text(model.first);
+        model.second->save(out);
+    }
+    if (!os) throw std::runtime_error("Could not write the checkpoint");
+}
+
+/*
+* Loads a snapshot into top, freshly built from the same models, and
+* returns the time to start its runner at.
+*/
+template<typename TIME>
+TIME restore_checkpoint(std::istream& is, const std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>& top) {
+    std::map<std::string, checkpointable<TIME>*> models;
+    checkpoint_detail::collect<TIME>(top, models);
+
+    char magic[sizeof(checkpoint_detail::magic)];
+    is.read(magic, sizeof(magic));
+    checkpoint_reader in(is);
+    uint8_t version = 0;
+    in.pod(version);
+    if (memcmp(magic, checkpoint_detail::magic, sizeof(magic)) != 0 || version != checkpoint_detail::version) {
+        throw std::runtime_error("Not a DISCO checkpoint (or an unsupported version)");
+    }
+
+    const TIME time = in.time<TIME>();
+    uint32_t count = 0;
+    in.pod(count);
+    if (count != models.size()) {
+        throw std::runtime_error("Checkpoint holds " + std::to_string(count) + " models, TOP has " + std::to_string(models.size()));
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const std::string id = in.text();
+        auto model = models.find(id);
+        if (model == models.end()) throw std::runtime_error("Checkpoint model " + id + " is not in TOP");
+        model->second->restore(in, time);
+    }
+    return time;
+}
+
+#endif // DISCO_CHECKPOINT_HPP
@@ -0,0 +1,392 @@
+/**
+* ARSLab - Carleton University
+*
+* Chrome trace:
+* Decorates an atomic model so its calls are written, as they happen, to a
+* Trace Event Format (JSON) file that chrome://tracing and ui.perfetto.dev
+* open. Each atomic is a track in two processes:
+*  - "Wall clock": every transition and output is a slice as long as the
+*    call took, and every message is a flow arrow from the output that
+*    sent it to the transition that received it, named after the port;
+*  - "Simulated time": every state is a slice from the transition that
+*    entered it to the next one, named after that transition, and every
+*    output an instant, at simulated microseconds.
+* Events are written straight to the stream: only the messages sent and
+* not yet received are kept, so memory does not grow with the run.
+*
+* chrome_trace::open must be called before TOP is built (atomics built
+* while it is closed are not traced and cost one test per call), connect
+* once it is built, and finish after the run. Writes are not synchronized:
+* traced runs use one thread.
+*/
+
+#ifndef DISCO_CHROME_TRACE_HPP
+#define DISCO_CHROME_TRACE_HPP
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cxxabi.h>
+
+#include <cadmium.h>
+
+#include "model_scope.hpp"
+#include "time_conversion.hpp"
+
+using namespace cadmium;
+
+class chrome_trace {
+    enum trace_process { wall_clock = 1, simulated_time = 2 };
+
+    //Atomics an output port's messages reach, through any depth of couplings
+    struct route {
+        std::type_index port;
+        std::string name;
+        std::vector<int> to;
+    };
+
+    struct track {
+        std::string id;
+        std::vector<route> routes;
+        std::vector<std::pair<unsigned long long, const std::string*>> received; //flows sent to it, not yet ended
+        const char* state = nullptr; //transition that entered the current state
+        double state_start = 0;
+    };
+
+    inline static std::ostream* _out = nullptr;
+    inline static std::chrono::steady_clock::time_point _start;
+    inline static std::vector<track> _tracks;
+    inline static std::unordered_map<std::string, int> _index;
+    inline static unsigned long long _next_flow = 1;
+    inline static unsigned long long _events = 0;
+    inline static double _latest = 0; //simulated time of the last event
+
+    static void write_string(const std::string& text) {
+        std::ostream& out = *_out;
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            if ((unsigned char) c < 0x20) continue;
+            out << c;
+        }
+        out << '"';
+    }
+
+    //Opens an event: {"ph":"X","pid":1,"tid":3,"ts":12.345
+    static std::ostream& begin_event(char phase, int process, int tid, double ts) {
+        std::ostream& out = *_out;
+        out << (_events++ ? ",\n" : "\n") << "{\"ph\":\"" << phase << "\",\"pid\":" << process << ",\"tid\":" << tid << ",\"ts\":" << ts;
+        return out;
+    }
+
+    static void write_metadata(const char* name, int process, int tid, const std::string& value) {
+        std::ostream& out = *_out;
+        out << (_events++ ? ",\n" : "\n") << "{\"ph\":\"M\",\"name\":\"" << name << "\",\"pid\":" << process << ",\"tid\":" << tid
+            << ",\"args\":{\"name\":";
+        write_string(value);
+        out << "}}";
+    }
+
+    static std::string demangled(const std::type_info& type) {
+        int status = 0;
+        char* name = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        std::string result = status == 0 ? name : type.name();
+        free(name);
+        return result;
+    }
+
+    template<typename TIME>
+    using coupled_ptr=std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>;
+
+    template<typename TIME>
+    static std::shared_ptr<cadmium::dynamic::modeling::model> child_of(const coupled_ptr<TIME>& coupled, const std::string& id) {
+        for (const auto& model : coupled->_models) {
+            if (model->get_id() == id) return model;
+        }
+        throw std::logic_error("Coupling to unknown model " + id + " in " + coupled->get_id());
+    }
+
+    //Messages entering child `to` of coupled on port: follow EICs down to atomics
+    template<typename TIME>
+    static void deliver(const coupled_ptr<TIME>& coupled, const std::string& to, std::type_index port, route& r) {
+        const auto child = child_of<TIME>(coupled, to);
+        if (auto nested = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(child)) {
+            for (const auto& eic : nested->_eic) {
+                if (eic._link->from() == port) deliver<TIME>(nested, eic._to, eic._link->to(), r);
+            }
+        } else {
+            auto traced = _index.find(to);
+            if (traced != _index.end()) r.to.push_back(traced->second);
+        }
+    }
+
+    //Messages leaving child `from_id` of ancestors.back() on port: follow ICs across and EOCs up
+    template<typename TIME>
+    static void follow(const std::vector<coupled_ptr<TIME>>& ancestors, const std::string& from_id, std::type_index port, route& r) {
+        const coupled_ptr<TIME>& coupled = ancestors.back();
+        for (const auto& ic : coupled->_ic) {
+            if (ic._from == from_id && ic._link->from() == port) deliver<TIME>(coupled, ic._to, ic._link->to(), r);
+        }
+        if (ancestors.size() < 2) return;
+        for (const auto& eoc : coupled->_eoc) {
+            if (eoc._from != from_id || eoc._link->from() != port) continue;
+            follow<TIME>(std::vector<coupled_ptr<TIME>>(ancestors.begin(), ancestors.end() - 1), coupled->get_id(), eoc._link->to(), r);
+        }
+    }
+
+    template<typename TIME>
+    static void add_routes(std::vector<coupled_ptr<TIME>>& ancestors) {
+        const coupled_ptr<TIME> coupled = ancestors.back();
+        for (const auto& model : coupled->_models) {
+            if (auto child = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(model)) {
+                ancestors.push_back(child);
+                add_routes<TIME>(ancestors);
+                ancestors.pop_back();
+                continue;
+            }
+            auto traced = _index.find(model->get_id());
+            if (traced == _index.end()) continue;
+            for (route& r : _tracks[traced->second].routes) {
+                follow<TIME>(ancestors, model->get_id(), r.port, r);
+            }
+        }
+    }
+
+    //Closes the state the track is in at simulated time sim
+    static void end_state(track& t, int tid, double sim) {
+        if (!t.state) return;
+        begin_event('X', simulated_time, tid, t.state_start) << ",\"dur\":" << sim - t.state_start << ",\"name\":\"" << t.state << "\"}";
+    }
+
+public:
+    static bool enabled() {
+        return _out != nullptr;
+    }
+
+    //Starts the trace; the wall clock starts now
+    static void open(std::ostream& out) {
+        _out = &out;
+        _start = std::chrono::steady_clock::now();
+        _events = 0;
+        out << std::fixed << std::setprecision(3) << "[";
+        write_metadata("process_name", wall_clock, 0, "Wall clock");
+        write_metadata("process_name", simulated_time, 0, "Simulated time");
+    }
+
+    //Microseconds since open
+    static double now() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    template<typename TIME>
+    static double simulated_us(const TIME& t) {
+        return time_conversion<TIME>::to_nanoseconds(t) / 1e3;
+    }
+
+    //The track of the atomic id, with the output ports of its messages
+    static int track_for(const std::string& id, std::vector<std::type_index> ports) {
+        const int tid = (int) _tracks.size() + 1;
+        track t;
+        t.id = id;
+        t.state = "initial";
+        for (const std::type_index& port : ports) t.routes.push_back(route{port, std::string(), {}});
+        _tracks.push_back(std::move(t));
+        _index[id] = tid - 1;
+        write_metadata("thread_name", wall_clock, tid, id);
+        write_metadata("thread_name", simulated_time, tid, id);
+        return tid;
+    }
+
+    //Port names, for the flow arrows
+    template<typename PORT>
+    static void name_port(int tid) {
+        for (route& r : _tracks[tid - 1].routes) {
+            if (r.port == std::type_index(typeid(PORT))) r.name = demangled(typeid(PORT));
+        }
+    }
+
+    //Resolves where each traced output port's messages go, once TOP is built
+    template<typename TIME>
+    static void connect(const coupled_ptr<TIME>& top) {
+        if (!enabled()) return;
+        std::vector<coupled_ptr<TIME>> ancestors{top};
+        add_routes<TIME>(ancestors);
+    }
+
+    //A transition of track tid taking wall [start, end], at simulated time sim
+    static void transition(int tid, const char* name, double start, double end, double sim) {
+        track& t = _tracks[tid - 1];
+        begin_event('X', wall_clock, tid, start) << ",\"dur\":" << end - start << ",\"name\":\"" << name
+            << "\",\"args\":{\"sim_us\":" << sim << "}}";
+        const double middle = start + (end - start) / 2;
+        for (const auto& flow : t.received) {
+            begin_event('f', wall_clock, tid, middle) << ",\"bp\":\"e\",\"cat\":\"message\",\"id\":" << flow.first << ",\"name\":";
+            write_string(*flow.second);
+            *_out << "}";
+        }
+        t.received.clear();
+
+        end_state(t, tid, sim);
+        t.state = name;
+        t.state_start = sim;
+        _latest = sim;
+    }
+
+    //An output of track tid taking wall [start, end], at simulated time sim, with messages on ports
+    static void output(int tid, double start, double end, double sim, const std::type_info* const* ports, size_t count) {
+        track& t = _tracks[tid - 1];
+        begin_event('X', wall_clock, tid, start) << ",\"dur\":" << end - start << ",\"name\":\"output\",\"args\":{\"sim_us\":" << sim << "}}";
+        begin_event('i', simulated_time, tid, sim) << ",\"s\":\"t\",\"name\":\"output\"}";
+        _latest = sim;
+
+        const double middle = start + (end - start) / 2;
+        for (size_t i = 0; i < count; i++) {
+            for (const route& r : t.routes) {
+                if (r.port != std::type_index(*ports[i])) continue;
+                for (int to : r.to) {
+                    const unsigned long long id = _next_flow++;
+                    begin_event('s', wall_clock, tid, middle) << ",\"cat\":\"message\",\"id\":" << id << ",\"name\":";
+                    write_string(r.name);
+                    *_out << "}";
+                    _tracks[to].received.emplace_back(id, &r.name);
+                }
+            }
+        }
+    }
+
+    //Simulated microseconds of the last transition or output, e.g. to finish a run stopped by an error
+    static double latest() {
+        return _latest;
+    }
+
+    //Closes every state at simulated time sim, and the trace; returns the events written
+    static unsigned long long finish(double sim) {
+        if (!enabled()) return 0;
+        for (size_t i = 0; i < _tracks.size(); i++) {
+            end_state(_tracks[i], (int) i + 1, sim);
+            _tracks[i].state = nullptr;
+        }
+        *_out << "\n]\n";
+        _out->flush();
+        _out = nullptr;
+        return _events;
+    }
+};
+
+/*
+* Usage: chrome_traced<Arbiter>::model, built inside a model_scope naming
+* it (make_disco_top does this for every atomic).
+*/
+template<template<typename> class ATOMIC>
+struct chrome_traced {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+        using output_bags=typename make_message_bags<typename base::output_ports>::type;
+
+        template<typename PORTS>
+        struct ports;
+
+        template<typename... PORTS>
+        struct ports<std::tuple<PORTS...>> {
+            static constexpr size_t count = sizeof...(PORTS);
+
+            static std::vector<std::type_index> all() {
+                return {std::type_index(typeid(PORTS))...};
+            }
+
+            static void name(int tid) {
+                (chrome_trace::name_port<PORTS>(tid), ...);
+            }
+
+            //The ports of bags holding messages, in sent; returns how many
+            static size_t with_messages(const output_bags& bags, const std::type_info** sent) {
+                size_t n = 0;
+                ((get_messages<PORTS>(bags).empty() ? void() : void(sent[n++] = &typeid(PORTS))), ...);
+                return n;
+            }
+        };
+
+        using traced_ports=ports<typename base::output_ports>;
+
+        int _track = 0; //0: not traced
+        TIME _last{0};
+        mutable TIME _next{0};
+
+        void transitioned(const char* name, double start, const TIME& t) {
+            const double end = chrome_trace::now();
+            chrome_trace::transition(_track, name, start, end, chrome_trace::simulated_us(t));
+            _last = t;
+        }
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...) {
+            if (chrome_trace::enabled()) {
+                _track = chrome_trace::track_for(model_scope::current(), traced_ports::all());
+                traced_ports::name(_track);
+            }
+        }
+
+        // internal transition
+        void internal_transition() {
+            if (!_track) return base::internal_transition();
+            const double start = chrome_trace::now();
+            base::internal_transition();
+            transitioned("internal", start, _next);
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            if (!_track) return base::external_transition(e, std::move(mbs));
+            const double start = chrome_trace::now();
+            base::external_transition(e, std::move(mbs));
+            transitioned("external", start, _last + e);
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            if (!_track) return base::confluence_transition(e, std::move(mbs));
+            const double start = chrome_trace::now();
+            base::confluence_transition(e, std::move(mbs));
+            transitioned("confluence", start, _last + e);
+        }
+
+        // output function
+        output_bags output() const {
+            if (!_track) return base::output();
+            const double start = chrome_trace::now();
+            output_bags bags = base::output();
+            const double end = chrome_trace::now();
+
+            const std::type_info* sent[traced_ports::count ? traced_ports::count : 1] = {};
+            const size_t count = traced_ports::with_messages(bags, sent);
+            chrome_trace::output(_track, start, end, chrome_trace::simulated_us(_next), sent, count);
+            return bags;
+        }
+
+        // time_advance function
+        TIME time_advance() const {
+            TIME ta = base::time_advance();
+            if (_track) _next = _last + ta;
+            return ta;
+        }
+    };
+};
+
+#endif // DISCO_CHROME_TRACE_HPP
@@ -0,0 +1,470 @@
+/**
+* ARSLab - Carleton University
+*
+* Flat runner:
+* Runs a dynamic TOP on one flat array of atomic simulators instead of
+* cadmium's tree of coordinators. Before the run starts, every EIC, IC and
+* EOC, through any depth of nested coupled models, is resolved into routes:
+* (source atomic, source port, links to apply, destination atomic). Each
+* source's routes are stored contiguously, ordered by port as its outbox
+* is, so delivering its outputs is one pass over the outbox and the routes
+* side by side: no coupling is looked up by model name, and no bag by
+* port, during the run. Only cadmium's links, which add the messages to
+* the receiver's inbox, still index that inbox by port.
+*
+* The events logged are the ones cadmium's coordinators log for the
+* logger_global_time, logger_messages and logger_state sources: every
+* round, the outbox of every atomic whose coupled models are imminent
+* (empty unless it is imminent itself), then the state of every atomic.
+* Outputs leaving TOP itself are dropped, as TOP has no parent to receive
+* them. A filtered_logger's selection is resolved here once: models it
+* does not name are never formatted, and of those it names only the
+* selected ports, logged only in the rounds they carry messages.
+*
+* Given a work_stealing_pool, the outputs of all imminent atomics, and then
+* the transitions of all imminents and receivers, of each simulated time
+* run in parallel on it. Atomics share no state, so only the order of the
+* log could differ: routing and logging stay on the calling thread, in
+* model order, after each parallel phase, and the log is the same as
+* without the pool. Transition counts made on pool threads are moved to
+* the calling thread.
+*
+* With idle_polls::skip, atomics that declared quiet periodic polls
+* (engine/quiescence.hpp), whose outputs reach no atomic, that receive
+* nothing and are not logged, are left out of the schedule and jumped
+* over their polls in one step when run_until returns (so their polls no
+* longer make their coupled model imminent in the log). idle_polls::verify
+* also checks every jump against stepping through the polls.
+*/
+
+#ifndef DISCO_FLAT_RUNNER_HPP
+#define DISCO_FLAT_RUNNER_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include <cadmium.h>
+
+#include "../loggers/filtered_logger.hpp"
+#include "quiescence.hpp"
+#include "transition_counter.hpp"
+#include "work_stealing_pool.hpp"
+
+//Whether LOGGER logs anything from SOURCE, so its events are worth formatting; assumed of other loggers
+template<typename LOGGER, typename SOURCE>
+struct logs_source : std::true_type {};
+
+template<typename SOURCE>
+struct logs_source<cadmium::logger::not_logger, SOURCE> : std::false_type {};
+
+template<typename LOGGING_SOURCE, typename FORMATTER, typename SINK, typename SOURCE>
+struct logs_source<cadmium::logger::logger<LOGGING_SOURCE, FORMATTER, SINK>, SOURCE> : std::is_same<LOGGING_SOURCE, SOURCE> {};
+
+template<typename... LOGGERS, typename SOURCE>
+struct logs_source<cadmium::logger::multilogger<LOGGERS...>, SOURCE> : std::disjunction<logs_source<LOGGERS, SOURCE>...> {};
+
+template<typename TIME, typename LOGGER>
+class flat_coordinator {
+    using selection=typename trace_selection_of<LOGGER>::type;
+    using event_logger=typename trace_selection_of<LOGGER>::logger;
+    static constexpr bool logs_messages = logs_source<event_logger, cadmium::logger::logger_messages>::value;
+    static constexpr bool logs_states = logs_source<event_logger, cadmium::logger::logger_state>::value;
+
+    using model_ptr=std::shared_ptr<cadmium::dynamic::modeling::model>;
+    using atomic_ptr=std::shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>>;
+    using coupled_ptr=std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>;
+    using link_ptr=std::shared_ptr<cadmium::dynamic::modeling::link_abstract>;
+    using bag_type=cadmium::dynamic::message_bags::mapped_type;
+
+    struct simulator {
+        atomic_ptr model;
+        TIME last;
+        TIME next;
+        cadmium::dynamic::message_bags inbox;
+        cadmium::dynamic::message_bags outbox;
+        size_t first_route = 0;
+        size_t routes = 0;
+        size_t coupled = 0; //innermost coupled model holding it, 0 for TOP
+
+        //Selected for logging, and the only ports logged (all if empty)
+        bool logged = true;
+        std::vector<std::type_index> logged_ports;
+
+        transition_counts counts; //of its last transition, when it ran on the pool
+
+        quiet_poller<TIME>* poller = nullptr; //off the schedule, its polls skipped
+    };
+
+    //Links are applied in order; most routes are a single IC
+    struct route {
+        size_t from;
+        std::type_index port;
+        std::vector<link_ptr> links;
+        size_t to;
+    };
+
+    std::vector<simulator> _simulators;
+    std::vector<route> _routes;
+    std::vector<size_t> _imminent;
+    std::vector<size_t> _receivers;
+    std::vector<char> _receiving;
+    std::vector<size_t> _transitions; //imminents and receivers, in model order
+    std::vector<size_t> _parents; //of every coupled model, TOP its own
+    std::vector<char> _coupled_imminent;
+    TIME _next;
+
+    work_stealing_pool* _pool;
+
+    idle_polls _polls;
+    std::vector<size_t> _quiet;
+
+    std::map<const cadmium::dynamic::modeling::model*, size_t> _index; //only used while flattening
+
+    void add_atomics(const coupled_ptr& coupled, size_t coupled_index) {
+        for (const model_ptr& model : coupled->_models) {
+            if (auto child = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(model)) {
+                _parents.push_back(coupled_index);
+                add_atomics(child, _parents.size() - 1);
+            } else if (auto atomic = std::dynamic_pointer_cast<cadmium::dynamic::modeling::atomic_abstract<TIME>>(model)) {
+                _index[atomic.get()] = _simulators.size();
+                _simulators.push_back(simulator{atomic});
+                _simulators.back().coupled = coupled_index;
+            } else {
+                throw std::logic_error("Model " + model->get_id() + " is neither atomic nor coupled");
+            }
+        }
+    }
+
+    static model_ptr child_of(const coupled_ptr& coupled, const std::string& id) {
+        for (const model_ptr& model : coupled->_models) {
+            if (model->get_id() == id) return model;
+        }
+        throw std::logic_error("Coupling to unknown model " + id + " in " + coupled->get_id());
+    }
+
+    //Messages entering child `to` of coupled on port: follow EICs down to atomics
+    void deliver(const coupled_ptr& coupled, const std::string& to, std::type_index port, std::vector<link_ptr> links, size_t from, std::type_index from_port) {
+        const model_ptr child = child_of(coupled, to);
+        if (auto nested = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(child)) {
+            for (const auto& eic : nested->_eic) {
+                if (eic._link->from() != port) continue;
+                std::vector<link_ptr> path = links;
+                path.push_back(eic._link);
+                deliver(nested, eic._to, eic._link->to(), path, from, from_port);
+            }
+        } else {
+            _routes.push_back(route{from, from_port, links, _index.at(child.get())});
+        }
+    }
+
+    //Messages leaving child `from_id` of ancestors.back() on port: follow ICs across and EOCs up
+    void follow(const std::vector<coupled_ptr>& ancestors, const std::string& from_id, std::type_index port, const std::vector<link_ptr>& links, size_t from, std::type_index from_port) {
+        const coupled_ptr& coupled = ancestors.back();
+        for (const auto& ic : coupled->_ic) {
+            if (ic._from != from_id || ic._link->from() != port) continue;
+            std::vector<link_ptr> path = links;
+            path.push_back(ic._link);
+            deliver(coupled, ic._to, ic._link->to(), path, from, from_port);
+        }
+        if (ancestors.size() < 2) return;
+        for (const auto& eoc : coupled->_eoc) {
+            if (eoc._from != from_id || eoc._link->from() != port) continue;
+            std::vector<link_ptr> path = links;
+            path.push_back(eoc._link);
+            follow(std::vector<coupled_ptr>(ancestors.begin(), ancestors.end() - 1), coupled->get_id(), eoc._link->to(), path, from, from_port);
+        }
+    }
+
+    //Every output port of every atomic: the ports are the ones its couplings name
+    void add_routes(std::vector<coupled_ptr>& ancestors) {
+        const coupled_ptr coupled = ancestors.back();
+        for (const model_ptr& model : coupled->_models) {
+            if (auto child = std::dynamic_pointer_cast<cadmium::dynamic::modeling::coupled<TIME>>(model)) {
+                ancestors.push_back(child);
+                add_routes(ancestors);
+                ancestors.pop_back();
+                continue;
+            }
+            const size_t from = _index.at(model.get());
+            std::vector<std::type_index> ports;
+            for (const auto& ic : coupled->_ic) {
+                if (ic._from == model->get_id()) ports.push_back(ic._link->from());
+            }
+            for (const auto& eoc : coupled->_eoc) {
+                if (eoc._from == model->get_id()) ports.push_back(eoc._link->from());
+            }
+            std::sort(ports.begin(), ports.end());
+            ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
+            for (const std::type_index& port : ports) {
+                follow(ancestors, model->get_id(), port, {}, from, port);
+            }
+        }
+    }
+
+    void route_messages(const route& r, const bag_type& bag) {
+        if (r.links.size() == 1) {
+            r.links.front()->route(bag, _simulators[r.to].inbox);
+        } else {
+            //Through nested couplings: one intermediate bag per hop, the only one in its map
+            cadmium::dynamic::message_bags hop;
+            r.links.front()->route(bag, hop);
+            for (size_t i = 1; i < r.links.size(); i++) {
+                if (hop.empty()) return;
+                cadmium::dynamic::message_bags next_hop;
+                r.links[i]->route(hop.begin()->second, i + 1 == r.links.size() ? _simulators[r.to].inbox : next_hop);
+                hop.swap(next_hop);
+            }
+        }
+        if (!_receiving[r.to]) {
+            _receiving[r.to] = 1;
+            _receivers.push_back(r.to);
+        }
+    }
+
+    void log_messages(const TIME& t, const simulator& s) {
+        if (s.logged_ports.empty()) {
+            event_logger::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, s.model->get_id(), s.model->messages_by_port_as_string(s.outbox));
+            return;
+        }
+        //logged_ports is sorted like the outbox
+        cadmium::dynamic::message_bags selected;
+        auto port = s.logged_ports.begin();
+        for (auto bag = s.outbox.begin(); bag != s.outbox.end() && port != s.logged_ports.end(); ) {
+            if (bag->first < *port) {
+                ++bag;
+            } else if (*port < bag->first) {
+                ++port;
+            } else {
+                selected.insert(selected.end(), *bag++);
+                ++port;
+            }
+        }
+        if (!selected.empty()) {
+            event_logger::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, s.model->get_id(), s.model->messages_by_port_as_string(selected));
+        }
+    }
+
+    //Cadmium's coordinators collect from their children only when imminent themselves
+    void log_collected(const TIME& t) {
+        _coupled_imminent.assign(_parents.size(), 0);
+        _coupled_imminent[0] = 1;
+        for (size_t i : _imminent) {
+            for (size_t c = _simulators[i].coupled; !_coupled_imminent[c]; c = _parents[c]) {
+                _coupled_imminent[c] = 1;
+            }
+        }
+        for (const simulator& s : _simulators) {
+            if (s.logged && _coupled_imminent[s.coupled]) log_messages(t, s);
+        }
+    }
+
+    void transition(size_t i, const TIME& t) {
+        simulator& s = _simulators[i];
+        const bool is_imminent = s.next == t;
+        if (is_imminent && _receiving[i]) {
+            s.model->confluence_transition(t - s.last, s.inbox);
+        } else if (is_imminent) {
+            s.model->internal_transition();
+        } else {
+            s.model->external_transition(t - s.last, s.inbox);
+        }
+        _receiving[i] = 0;
+        s.last = t;
+        s.next = t + s.model->time_advance();
+        s.inbox.clear();
+        s.outbox.clear();
+    }
+
+    void find_imminent() {
+        _next = TIME::infinity();
+        _imminent.clear();
+        for (size_t i = 0; i < _simulators.size(); i++) {
+            if (_simulators[i].poller) continue;
+            const TIME& next = _simulators[i].next;
+            if (next < _next) {
+                _next = next;
+                _imminent.clear();
+            }
+            if (next == _next && next != TIME::infinity()) _imminent.push_back(i);
+        }
+    }
+
+    //Declared quiet, routed nowhere, receiving nothing and not logged
+    void find_quiet_pollers() {
+        std::vector<char> received(_simulators.size(), 0);
+        for (const route& r : _routes) {
+            received[r.to] = 1;
+        }
+        const bool logging = logs_messages || logs_states;
+        for (size_t i = 0; i < _simulators.size(); i++) {
+            simulator& s = _simulators[i];
+            auto poller = dynamic_cast<quiet_poller<TIME>*>(s.model.get());
+            if (!poller || !poller->quiet() || s.routes || received[i] || (logging && s.logged)) continue;
+            s.poller = poller;
+            _quiet.push_back(i);
+        }
+    }
+
+public:
+    explicit flat_coordinator(const coupled_ptr& top, work_stealing_pool* pool = nullptr, idle_polls polls = idle_polls::step)
+        : _pool(pool && pool->size() > 1 ? pool : nullptr), _polls(polls) {
+        _parents.push_back(0);
+        add_atomics(top, 0);
+        std::vector<coupled_ptr> ancestors{top};
+        add_routes(ancestors);
+        _index.clear();
+
+        //add_routes gives each source's routes in port order; keep it
+        std::stable_sort(_routes.begin(), _routes.end(), [](const route& a, const route& b) { return a.from < b.from; });
+        for (size_t r = 0; r < _routes.size(); r++) {
+            simulator& s = _simulators[_routes[r].from];
+            if (s.routes == 0) s.first_route = r;
+            s.routes++;
+        }
+        _receiving.assign(_simulators.size(), 0);
+
+        if constexpr (!std::is_void<selection>::value) {
+            for (simulator& s : _simulators) {
+                s.logged = selection::selects(s.model->get_id());
+                if (s.logged && !selection::selected_ports(s.model->get_id(), s.logged_ports)) s.logged_ports.clear();
+                std::sort(s.logged_ports.begin(), s.logged_ports.end());
+                s.logged_ports.erase(std::unique(s.logged_ports.begin(), s.logged_ports.end()), s.logged_ports.end());
+            }
+        }
+        if (_polls != idle_polls::step) {
+            find_quiet_pollers();
+        }
+    }
+
+    void init(const TIME& t) {
+        for (simulator& s : _simulators) {
+            s.last = t;
+            s.next = t + s.model->time_advance();
+        }
+        find_imminent();
+    }
+
+    TIME next() const {
+        return _next;
+    }
+
+    //Brings the quiet pollers to until, as if every poll before it had been stepped
+    void skip_idle_polls(const TIME& until) {
+        for (size_t i : _quiet) {
+            simulator& s = _simulators[i];
+            s.poller->skip_polls(s.last, s.next, until, _polls == idle_polls::verify);
+        }
+    }
+
+    size_t quiet_pollers() const {
+        return _quiet.size();
+    }
+
+    void collect_outputs(const TIME& t) {
+        if (_pool) {
+            _pool->run(_imminent.size(), [this](size_t k) {
+                simulator& s = _simulators[_imminent[k]];
+                s.outbox = s.model->output();
+            });
+        }
+        for (size_t i : _imminent) {
+            simulator& s = _simulators[i];
+            if (!_pool) s.outbox = s.model->output();
+
+            //Both in port order: each bag meets its routes without a lookup
+            const size_t end = s.first_route + s.routes;
+            size_t r = s.first_route;
+            for (auto bag = s.outbox.begin(); bag != s.outbox.end() && r < end; ) {
+                const std::type_index& routed = _routes[r].port;
+                if (bag->first < routed) {
+                    ++bag;
+                } else if (routed < bag->first) {
+                    r++;
+                } else {
+                    route_messages(_routes[r++], bag->second);
+                }
+            }
+        }
+        if constexpr (logs_messages) {
+            log_collected(t);
+        }
+    }
+
+    void advance_simulation(const TIME& t) {
+        //Imminent models and receivers merged in model order, as cadmium logs them
+        std::sort(_receivers.begin(), _receivers.end());
+        _transitions.clear();
+        std::set_union(_imminent.begin(), _imminent.end(), _receivers.begin(), _receivers.end(), std::back_inserter(_transitions));
+
+        if (_pool) {
+            _pool->run(_transitions.size(), [this, &t](size_t k) {
+                const transition_counts counted_before = transition_counts::take();
+                transition(_transitions[k], t);
+                _simulators[_transitions[k]].counts = transition_counts::take();
+                counted_before.add();
+            });
+        } else {
+            for (size_t i : _transitions) {
+                transition(i, t);
+            }
+        }
+
+        if (_pool) {
+            for (size_t i : _transitions) {
+                _simulators[i].counts.add();
+            }
+        }
+        //Cadmium logs the state of every atomic, transitioned or not
+        if constexpr (logs_states) {
+            for (const simulator& s : _simulators) {
+                if (s.logged) {
+                    event_logger::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(t, s.model->get_id(), s.model->model_state_as_string());
+                }
+            }
+        }
+        _receivers.clear();
+        find_imminent();
+    }
+};
+
+//Same interface as cadmium::dynamic::engine::runner
+template<typename TIME, typename LOGGER>
+class flat_runner {
+    flat_coordinator<TIME, LOGGER> _top_coordinator;
+    TIME _next;
+
+public:
+    //With a pool, the atomics of each simulated time run in parallel on it
+    flat_runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME& init_time,
+                work_stealing_pool* pool = nullptr, idle_polls polls = idle_polls::step)
+        : _top_coordinator(coupled_model, pool, polls) {
+        _top_coordinator.init(init_time);
+        _next = _top_coordinator.next();
+    }
+
+    TIME run_until(const TIME& t) {
+        while (_next < t) {
+            LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
+            _top_coordinator.collect_outputs(_next);
+            _top_coordinator.advance_simulation(_next);
+            _next = _top_coordinator.next();
+        }
+        _top_coordinator.skip_idle_polls(t);
+        return _next;
+    }
+
+    //Atomics whose polls are skipped
+    size_t quiet_pollers() const {
+        return _top_coordinator.quiet_pollers();
+    }
+};
+
+#endif // DISCO_FLAT_RUNNER_HPP
@@ -0,0 +1,150 @@
+/**
+* ARSLab - Carleton University
+*
+* Fused models:
+* Runs two coupled atomics, FIRST -> SECOND, as a single atomic. FIRST's
+* output on FIRST_OUT reaches SECOND on SECOND_IN within the same
+* transition, so a zero time advance in FIRST (e.g. Switch passing a
+* sample on) costs the engine no extra round. The fused model has FIRST's
+* input ports and SECOND's output ports, and from outside it shows the
+* same outputs at the same simulated times as the two models coupled.
+*
+* Only valid when FIRST_OUT feeds nothing but SECOND and SECOND takes no
+* other input; the model ids of the pair are replaced by the fused id.
+*/
+
+#ifndef DISCO_FUSED_MODEL_HPP
+#define DISCO_FUSED_MODEL_HPP
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+using namespace cadmium;
+
+template<template<typename> class FIRST, template<typename> class SECOND, typename FIRST_OUT, typename SECOND_IN>
+struct fused {
+
+    template<typename TIME>
+    class model {
+        using first_inputs=typename make_message_bags<typename FIRST<TIME>::input_ports>::type;
+        using second_inputs=typename make_message_bags<typename SECOND<TIME>::input_ports>::type;
+
+        static_assert(std::tuple_size<typename SECOND<TIME>::input_ports>::value == 1,
+                      "the second model of a fused pair can only take input from the first");
+
+        static TIME remaining(const TIME& time_advance, const TIME& elapsed) {
+            return time_advance == TIME::infinity() ? TIME::infinity() : time_advance - elapsed;
+        }
+
+        //FIRST's output bag is handed on, not copied
+        static second_inputs translate(typename make_message_bags<typename FIRST<TIME>::output_ports>::type outputs) {
+            second_inputs inputs;
+            get_messages<SECOND_IN>(inputs) = std::move(get_messages<FIRST_OUT>(outputs));
+            return inputs;
+        }
+
+        //Every component transition at the current time, then FIRST's zero-time outputs handed straight on
+        void transition(const TIME& e, const first_inputs* mbs) {
+            state.first_elapsed = state.first_elapsed + e;
+            state.second_elapsed = state.second_elapsed + e;
+            const bool first_imminent = state.first.time_advance() == state.first_elapsed;
+            const bool second_imminent = state.second.time_advance() == state.second_elapsed;
+
+            if (first_imminent) {
+                const second_inputs inputs = translate(state.first.output());
+                const bool has_inputs = !get_messages<SECOND_IN>(inputs).empty();
+                if (second_imminent && has_inputs) {
+                    state.second.confluence_transition(state.second_elapsed, inputs);
+                } else if (second_imminent) {
+                    state.second.internal_transition();
+                } else if (has_inputs) {
+                    state.second.external_transition(state.second_elapsed, inputs);
+                }
+                if (second_imminent || has_inputs) state.second_elapsed = TIME();
+            } else if (second_imminent) {
+                state.second.internal_transition();
+                state.second_elapsed = TIME();
+            }
+
+            if (first_imminent && mbs) {
+                state.first.confluence_transition(state.first_elapsed, *mbs);
+            } else if (first_imminent) {
+                state.first.internal_transition();
+            } else if (mbs) {
+                state.first.external_transition(state.first_elapsed, *mbs);
+            }
+            if (first_imminent || mbs) state.first_elapsed = TIME();
+
+            //SECOND must output any pending result before it takes the next one
+            while (state.first.time_advance() == TIME::zero() && remaining(state.second.time_advance(), state.second_elapsed) != TIME::zero()) {
+                const second_inputs inputs = translate(state.first.output());
+                state.first.internal_transition();
+                if (!get_messages<SECOND_IN>(inputs).empty()) {
+                    state.second.external_transition(state.second_elapsed, inputs);
+                    state.second_elapsed = TIME();
+                }
+            }
+        }
+
+    public:
+        // state definition: both models and the time since each one's last transition
+        struct state_type {
+            FIRST<TIME> first;
+            SECOND<TIME> second;
+            TIME first_elapsed;
+            TIME second_elapsed;
+        };
+        state_type state;
+
+        // ports definition
+        using input_ports=typename FIRST<TIME>::input_ports;
+        using output_ports=typename SECOND<TIME>::output_ports;
+
+        // default constructor
+        model() {
+            state.first_elapsed = TIME();
+            state.second_elapsed = TIME();
+        }
+
+        // internal transition
+        void internal_transition() {
+            transition(time_advance(), nullptr);
+        }
+
+        // external transition
+        void external_transition(TIME e, first_inputs mbs) {
+            transition(e, &mbs);
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, first_inputs mbs) {
+            transition(e, &mbs);
+        }
+
+        // output function: only SECOND's outputs leave the pair
+        typename make_message_bags<output_ports>::type output() const {
+            if (remaining(state.second.time_advance(), state.second_elapsed) == time_advance()) {
+                return state.second.output();
+            }
+            return typename make_message_bags<output_ports>::type();
+        }
+
+        // time_advance function
+        TIME time_advance() const {
+            const TIME first = remaining(state.first.time_advance(), state.first_elapsed);
+            const TIME second = remaining(state.second.time_advance(), state.second_elapsed);
+            return first < second ? first : second;
+        }
+
+        friend std::ostringstream& operator<<(std::ostringstream& os, const state_type& i) {
+            os << i.first.state;
+            os << "; ";
+            os << i.second.state;
+            return os;
+        }
+    };
+};
+
+#endif // DISCO_FUSED_MODEL_HPP
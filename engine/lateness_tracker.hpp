@@ -0,0 +1,169 @@
+/**
+* ARSLab - Carleton University
+*
+* Lateness tracker:
+* Decorates an atomic model so every scheduled event (internal or
+* confluence transition) records how late it started against the wall
+* clock, in microseconds, into a log_histogram for that model. Histograms
+* live in a fixed table, so memory stays constant however long the run.
+*
+* lateness_clock::start() must be called when the run starts; the host
+* realtime_runner does it itself.
+*/
+
+#ifndef DISCO_LATENESS_TRACKER_HPP
+#define DISCO_LATENESS_TRACKER_HPP
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#ifdef RT_ARM_MBED
+#include "../mbed.h"
+#else
+#include <chrono>
+#endif
+
+#include "time_conversion.hpp"
+#include "model_scope.hpp"
+#include "model_table.hpp"
+#include "../data_structures/log_histogram.hpp"
+
+using namespace cadmium;
+
+#ifndef DISCO_LATENESS_MAX_MODELS
+#define DISCO_LATENESS_MAX_MODELS 8
+#endif
+
+//Wall clock the deadlines are measured against
+class lateness_clock {
+    #ifdef RT_ARM_MBED
+    static mbed::Timer& timer() {
+        static mbed::Timer t;
+        return t;
+    }
+    #else
+    inline static std::chrono::steady_clock::time_point _origin;
+    #endif
+    inline static double _speedup = 1.0;
+
+    static int64_t elapsed_us() {
+        #ifdef RT_ARM_MBED
+        return (int64_t) timer().read_high_resolution_us();
+        #else
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _origin).count();
+        #endif
+    }
+
+public:
+    //Simulation time zero is now; speedup as for realtime_runner
+    static void start(double speedup = 1.0) {
+        _speedup = speedup;
+        #ifdef RT_ARM_MBED
+        timer().reset();
+        timer().start();
+        #else
+        _origin = std::chrono::steady_clock::now();
+        #endif
+    }
+
+    //Wall microseconds since the event due at simulated due_ns should have started (0 if not yet)
+    static uint64_t lateness_us(int64_t due_ns) {
+        const int64_t lateness = elapsed_us() - (int64_t) (due_ns / 1000 / _speedup);
+        return lateness > 0 ? (uint64_t) lateness : 0;
+    }
+};
+
+class lateness_report {
+public:
+    using histogram=log_histogram<>;
+
+private:
+    inline static model_table<histogram, DISCO_LATENESS_MAX_MODELS> _table;
+
+public:
+    //Histogram of the model with this id (models past the table share "(others)")
+    static histogram* histogram_for(const char* id) {
+        return _table.stats_for(id);
+    }
+
+    static void reset() {
+        _table.reset();
+    }
+
+    static void print(std::ostream& os) {
+        os << std::left << std::setw(24) << "Lateness (us)" << std::right
+           << std::setw(10) << "events" << std::setw(10) << "p50" << std::setw(10) << "p99"
+           << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+        for (int i = 0; i < _table.size(); i++) {
+            const histogram& h = _table[i].stats;
+            if (h.count() == 0) continue;
+            os << std::left << std::setw(24) << _table[i].id << std::right
+               << std::setw(10) << h.count()
+               << std::setw(10) << h.percentile(0.50)
+               << std::setw(10) << h.percentile(0.99)
+               << std::setw(10) << h.percentile(0.999)
+               << std::setw(10) << h.max() << "\n";
+        }
+    }
+};
+
+/*
+* Usage: lateness_tracked<LCD>::model, built inside a model_scope naming it
+* (make_disco_top does this for every atomic).
+*/
+template<template<typename> class ATOMIC>
+struct lateness_tracked {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+        using conversion=time_conversion<TIME>;
+
+        lateness_report::histogram* _lateness;
+        TIME _last{0};
+        mutable TIME _next{0};
+
+        //Converted only here, once per scheduled event, without formatting
+        void record_due_event() {
+            _lateness->record(lateness_clock::lateness_us(conversion::count_nanoseconds(_next)));
+            _last = _next;
+        }
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...) {
+            _lateness = lateness_report::histogram_for(model_scope::current());
+        }
+
+        // internal transition
+        void internal_transition() {
+            record_due_event();
+            base::internal_transition();
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            _last = _last + e;
+            base::external_transition(e, std::move(mbs));
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            record_due_event();
+            base::confluence_transition(e, std::move(mbs));
+        }
+
+        // time_advance function, also the next due event: the engine asks after every transition and at init
+        TIME time_advance() const {
+            const TIME ta = base::time_advance();
+            _next = _last + ta;
+            return ta;
+        }
+    };
+};
+
+#endif // DISCO_LATENESS_TRACKER_HPP
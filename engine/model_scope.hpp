@@ -0,0 +1,37 @@
+/**
+* ARSLab - Carleton University
+*
+* Model scope:
+* The engine hands ids to its own model wrappers only, so decorators that
+* keep per-model statistics cannot see them. make_disco_top builds every
+* atomic inside a model_scope; a decorator reads model_scope::current()
+* from its constructor to learn which model it wraps.
+*/
+
+#ifndef DISCO_MODEL_SCOPE_HPP
+#define DISCO_MODEL_SCOPE_HPP
+
+class model_scope {
+    inline static thread_local const char* _current = "";
+    const char* _previous;
+
+public:
+    //id must outlive the scope
+    explicit model_scope(const char* id) : _previous(_current) {
+        _current = id;
+    }
+
+    ~model_scope() {
+        _current = _previous;
+    }
+
+    model_scope(const model_scope&) = delete;
+    model_scope& operator=(const model_scope&) = delete;
+
+    //Id of the atomic being built ("" outside any scope)
+    static const char* current() {
+        return _current;
+    }
+};
+
+#endif // DISCO_MODEL_SCOPE_HPP
@@ -0,0 +1,74 @@
+/**
+* ARSLab - Carleton University
+*
+* Model table:
+* Fixed table of per-model statistics, found by model id, for the reports
+* of the decorators (lateness, transition and allocation profiles). Memory
+* stays constant however many models there are: once all rows but the
+* last hold a model, every further model shares the last row, "(others)",
+* and the rows already taken keep their models.
+*/
+
+#ifndef DISCO_MODEL_TABLE_HPP
+#define DISCO_MODEL_TABLE_HPP
+
+#include <cstring>
+
+template<typename STATS, int MAX_MODELS, int ID_SIZE = 24>
+class model_table {
+    static_assert(MAX_MODELS >= 2, "a model table needs a row for a model and one for the others");
+
+public:
+    struct entry {
+        char id[ID_SIZE];
+        STATS stats;
+    };
+
+private:
+    entry _entries[MAX_MODELS];
+    int _used = 0;
+
+    //In place where STATS has reset() (a histogram is too big for a temporary on the board's stack)
+    template<typename S>
+    static auto clear(S& stats, int) -> decltype(stats.reset(), void()) {
+        stats.reset();
+    }
+
+    template<typename S>
+    static void clear(S& stats, long) {
+        stats = S();
+    }
+
+    int add(const char* id) {
+        entry& e = _entries[_used];
+        strncpy(e.id, id, ID_SIZE - 1);
+        e.id[ID_SIZE - 1] = '\0';
+        clear(e.stats, 0);
+        return _used++;
+    }
+
+public:
+    //Row of the model with this id, added if new
+    int row_for(const char* id) {
+        for (int i = 0; i < _used; i++) {
+            if (strncmp(_entries[i].id, id, ID_SIZE - 1) == 0) return i;
+        }
+        if (_used < MAX_MODELS - 1) return add(id);
+        if (_used == MAX_MODELS - 1) add("(others)");
+        return MAX_MODELS - 1;
+    }
+
+    STATS* stats_for(const char* id) {
+        return &_entries[row_for(id)].stats;
+    }
+
+    void reset() {
+        _used = 0;
+    }
+
+    int size() const { return _used; }
+    entry& operator[](int row) { return _entries[row]; }
+    const entry& operator[](int row) const { return _entries[row]; }
+};
+
+#endif // DISCO_MODEL_TABLE_HPP
@@ -0,0 +1,103 @@
+/**
+* ARSLab - Carleton University
+*
+* Pooled allocation:
+* Replaces the global operator new and delete with block_pool
+* (data_structures/block_pool.hpp). Every message bag an output() builds,
+* the vectors in it, and the copies the engine makes of them while routing
+* are small blocks freed within the same event, so after the first events
+* of each kind they are recycled instead of reaching malloc: a steady-state
+* run makes no heap allocations per event.
+*
+* With -DDISCO_ALLOC_PROFILE on the host every block is also tagged with the
+* allocation_scope it is allocated in, and charged to it in
+* allocation_report (engine/allocation_profiler.hpp) until released.
+*
+* Include in exactly one translation unit (main.cpp does with
+* -DDISCO_POOLED_ALLOC or -DDISCO_ALLOC_PROFILE). Over-aligned new and
+* delete are left to the library.
+*/
+
+#ifndef DISCO_POOLED_ALLOCATION_HPP
+#define DISCO_POOLED_ALLOCATION_HPP
+
+#include <cstdlib>
+#include <new>
+
+#include "../data_structures/block_pool.hpp"
+#include "allocation_profiler.hpp"
+
+namespace disco_pooled_allocation {
+    //nullptr if out of memory
+    inline void* try_allocate(size_t size) {
+        #if defined(DISCO_ALLOC_PROFILE) && !defined(RT_ARM_MBED)
+        const uint32_t tag = allocation_scope::current();
+        void* p = block_pool::allocate(size, tag);
+        if (p) allocation_report::charge(tag, 1, size, (long long) size);
+        return p;
+        #else
+        return block_pool::allocate(size);
+        #endif
+    }
+
+    inline void* allocate(size_t size) {
+        void* p = try_allocate(size);
+        if (!p) {
+            #ifdef __cpp_exceptions
+            throw std::bad_alloc();
+            #else
+            abort();
+            #endif
+        }
+        return p;
+    }
+
+    inline void release(void* p) {
+        #if defined(DISCO_ALLOC_PROFILE) && !defined(RT_ARM_MBED)
+        if (p) allocation_report::release(block_pool::tag_of(p), block_pool::size_of(p));
+        #endif
+        block_pool::release(p);
+    }
+}
+
+void* operator new(size_t size) {
+    return disco_pooled_allocation::allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return disco_pooled_allocation::allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return disco_pooled_allocation::try_allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return disco_pooled_allocation::try_allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+void operator delete[](void* p) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    disco_pooled_allocation::release(p);
+}
+
+#endif // DISCO_POOLED_ALLOCATION_HPP
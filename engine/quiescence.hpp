@@ -0,0 +1,154 @@
+/**
+* ARSLab - Carleton University
+*
+* Quiescent pollers:
+* An atomic declares (by specializing quiet_polls) that it polls on a fixed
+* period and that its internal transitions change nothing but its own
+* state and output. While nothing receives that output and nothing is
+* logged for it, flat_runner takes it off the schedule and, whenever a
+* run_until returns, jumps it over all the polls it skipped in one step:
+* the count comes from the period, and quiet_polls<ATOMIC>::skip moves the
+* state forward by that many transitions without any output, routing or
+* scheduling.
+*
+* In verify mode each jump is checked against a copy of the model stepped
+* through the same polls one by one: same time advance at every poll, and
+* the same state at the end.
+*/
+
+#ifndef DISCO_QUIESCENCE_HPP
+#define DISCO_QUIESCENCE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "model_scope.hpp"
+#include "time_conversion.hpp"
+
+//Not declared: the model is always stepped by the engine
+template<template<typename> class ATOMIC>
+struct quiet_polls {
+    static constexpr bool declared = false;
+};
+
+//What a specialization of quiet_polls can derive from: skip steps the model n times (a model that can jump its state declares its own skip)
+template<template<typename> class ATOMIC>
+struct periodic_polls {
+    static constexpr bool declared = true;
+
+    template<typename TIME>
+    static void skip(ATOMIC<TIME>& model, unsigned long long n) {
+        for (unsigned long long i = 0; i < n; i++) {
+            model.internal_transition();
+        }
+    }
+};
+
+//Polls jumped over, per thread like transition_counter (they are not counted there)
+struct skipped_polls {
+    inline static thread_local unsigned long long count = 0;
+};
+
+enum class idle_polls { step, skip, verify };
+
+template<typename TIME>
+class quiet_poller {
+public:
+    virtual ~quiet_poller() = default;
+
+    //Whether the model declared its polls quiet
+    virtual bool quiet() const = 0;
+
+    //Jumps over the polls due before until, the first at next, and moves last and next past them
+    virtual void skip_polls(TIME& last, TIME& next, const TIME& until, bool verify) = 0;
+};
+
+/*
+* Usage: quiescent<DigitalTemperatureHumidity>::model. Like checkpointed it
+* must wrap the atomic itself: stacked<counted, quiescent>. Skipped polls
+* do not go through the outer decorators.
+*/
+template<template<typename> class ATOMIC>
+struct quiescent {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME>, public quiet_poller<TIME> {
+        using base=ATOMIC<TIME>;
+        using conversion=time_conversion<TIME>;
+
+        std::string _model_id;
+
+        //Skips n polls, and steps a copy of the model from before through them one by one to compare
+        void skip_verified(unsigned long long n, const TIME& period) {
+            if constexpr (std::is_copy_constructible<base>::value) {
+                base stepped(static_cast<const base&>(*this));
+                quiet_polls<ATOMIC>::skip(static_cast<base&>(*this), n);
+                for (unsigned long long i = 0; i < n; i++) {
+                    if (stepped.time_advance() != period) {
+                        throw std::runtime_error("Polls of " + _model_id + " are declared periodic, but the time advance changed");
+                    }
+                    stepped.internal_transition();
+                }
+                if (!same_state(stepped.state, base::state) || stepped.time_advance() != base::time_advance()) {
+                    throw std::runtime_error("Skipping " + std::to_string(n) + " polls of " + _model_id + " differs from stepping through them");
+                }
+            } else {
+                throw std::logic_error("Polls of " + _model_id + " cannot be verified: the model cannot be copied");
+            }
+        }
+
+        template<typename STATE>
+        static bool same_state(const STATE& a, const STATE& b) {
+            if constexpr (std::is_trivially_copyable<STATE>::value) {
+                return memcmp(&a, &b, sizeof(STATE)) == 0;
+            } else {
+                std::ostringstream text_a, text_b;
+                text_a << a;
+                text_b << b;
+                return text_a.str() == text_b.str();
+            }
+        }
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...), _model_id(model_scope::current()) {}
+
+        bool quiet() const override {
+            return quiet_polls<ATOMIC>::declared;
+        }
+
+        void skip_polls(TIME& last, TIME& next, const TIME& until, bool verify) override {
+            if constexpr (quiet_polls<ATOMIC>::declared) {
+                //A run to infinity never returns to catch the polls up
+                if (!(next < until) || until == TIME::infinity()) return;
+
+                int fields = 4;
+                const TIME period = base::time_advance();
+                const int64_t period_ns = conversion::to_nanoseconds(period);
+                const int64_t next_ns = conversion::to_nanoseconds(next, &fields);
+                const int64_t until_ns = conversion::to_nanoseconds(until);
+                if (period_ns <= 0 || period_ns == conversion::infinity) {
+                    throw std::logic_error("Polls of " + _model_id + " are declared periodic, but the time advance is not a finite period");
+                }
+                const unsigned long long n = (unsigned long long) ((until_ns - next_ns + period_ns - 1) / period_ns);
+
+                if (verify) {
+                    skip_verified(n, period);
+                } else {
+                    quiet_polls<ATOMIC>::skip(static_cast<base&>(*this), n);
+                }
+                skipped_polls::count += n;
+
+                last = conversion::from_nanoseconds(next_ns + (int64_t) (n - 1) * period_ns, fields);
+                next = last + period;
+            }
+        }
+    };
+};
+
+#endif // DISCO_QUIESCENCE_HPP
@@ -0,0 +1,148 @@
+/**
+* ARSLab - Carleton University
+*
+* Real-time runner:
+* Runs a dynamic TOP like cadmium's dynamic runner, but waits on a wake-up
+* clock (wakeup_clocks.hpp) until each event is due: steady_clock on the
+* host, a low-power timer and sleep on target (tickless idle), or a virtual
+* clock in tests and benchmarks. A speed-up factor compresses the schedule
+* (2 runs twice as fast as real time). Deadlines are absolute from the
+* first run_until, so lateness does not accumulate from one event to the
+* next.
+*
+* Missed deadlines follow the board: an event that starts more than
+* MISSED_DEADLINE_TOLERANCE microseconds after it was due stops the run
+* (missed_deadline on the host, a hard fault on target). A negative
+* tolerance disables the check. A LOGGER with a static
+* missed_deadline(t, lateness_us), such as flight_recorder, is told first.
+* The lateness of every wake-up is kept in a log histogram.
+*/
+
+#ifndef DISCO_REALTIME_RUNNER_HPP
+#define DISCO_REALTIME_RUNNER_HPP
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <cadmium.h>
+
+#ifdef RT_ARM_MBED
+#include <cadmium/real_time/arm_mbed/embedded_error.hpp>
+#endif
+
+#include "time_conversion.hpp"
+#include "lateness_tracker.hpp"
+#include "wakeup_clocks.hpp"
+#include "../data_structures/log_histogram.hpp"
+
+#ifdef RT_ARM_MBED
+using default_wakeup_clock=tickless_clock;
+#else
+using default_wakeup_clock=steady_sleep_clock;
+
+class missed_deadline : public std::runtime_error {
+public:
+    missed_deadline(const std::string& time, long long lateness_us)
+        : std::runtime_error("MISSED SCHEDULED TIME ADVANCE DEADLINE at " + time + " (late by "
+                             + std::to_string(lateness_us) + " us)") {}
+};
+#endif
+
+//Whether LOGGER wants to know about a missed deadline before the run stops
+template<typename TIME, typename LOGGER, typename = void>
+struct notifies_missed_deadline : std::false_type {};
+
+template<typename TIME, typename LOGGER>
+struct notifies_missed_deadline<TIME, LOGGER, std::void_t<decltype(LOGGER::missed_deadline(std::declval<const TIME&>(), 0LL))>> : std::true_type {};
+
+template<typename TIME, typename LOGGER, typename CLOCK = default_wakeup_clock>
+class realtime_runner {
+    using conversion=time_conversion<TIME>;
+
+    cadmium::dynamic::engine::coordinator<TIME, LOGGER> _top_coordinator;
+    TIME _next;
+    int64_t _init_ns;
+    double _speedup;
+    long long _tolerance_us;
+
+    CLOCK _clock;
+    bool _started = false;
+
+    long long _max_lateness_us = 0;
+    unsigned long long _late_events = 0;
+    log_histogram<> _wake_lateness;
+
+    void missed(long long lateness_us) {
+        if constexpr (notifies_missed_deadline<TIME, LOGGER>::value) {
+            LOGGER::missed_deadline(_next, lateness_us);
+        }
+        #ifdef RT_ARM_MBED
+        cadmium::embedded::embedded_error::hard_fault("MISSED SCHEDULED TIME ADVANCE DEADLINE");
+        #else
+        std::ostringstream oss;
+        oss << _next;
+        throw missed_deadline(oss.str(), lateness_us);
+        #endif
+    }
+
+public:
+    //clock_args construct the clock (e.g. latency and jitter of a virtual_clock)
+    template<typename... CLOCK_ARGS>
+    realtime_runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> coupled_model, const TIME& init_time,
+                    double speedup, long long tolerance_us, CLOCK_ARGS&&... clock_args)
+        : _top_coordinator(coupled_model), _speedup(speedup), _tolerance_us(tolerance_us),
+          _clock(std::forward<CLOCK_ARGS>(clock_args)...) {
+        #ifndef RT_ARM_MBED
+        if (speedup <= 0) throw std::invalid_argument("real-time speed-up must be positive");
+        #endif
+        _top_coordinator.init(init_time);
+        _next = _top_coordinator.next();
+        _init_ns = conversion::to_nanoseconds(init_time);
+    }
+
+    //Runs until the next event is at or after t, or TOP passivates; returns the next event time
+    TIME run_until(const TIME& t) {
+        if (!_started) {
+            _clock.start();
+            lateness_clock::start(_speedup); //deadlines of lateness_tracked models
+            _started = true;
+        }
+
+        while (_next < t) {
+            const int64_t next_ns = conversion::count_nanoseconds(_next);
+            if (next_ns == conversion::infinity) break;
+
+            const int64_t due_us = (int64_t) ((next_ns - _init_ns) / 1000 / _speedup);
+            _clock.sleep_until(due_us);
+
+            const long long lateness_us = _clock.now_us() - due_us;
+            _wake_lateness.record(lateness_us > 0 ? (uint64_t) lateness_us : 0);
+            if (lateness_us > 0) {
+                _late_events++;
+                if (lateness_us > _max_lateness_us) _max_lateness_us = lateness_us;
+                if (_tolerance_us >= 0 && lateness_us > _tolerance_us) missed(lateness_us);
+            }
+
+            LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(_next);
+            _top_coordinator.collect_outputs(_next);
+            _top_coordinator.advance_simulation(_next);
+            _next = _top_coordinator.next();
+        }
+        return _next;
+    }
+
+    //Worst lateness seen (0 if every event started on time) and how many events started late
+    long long max_lateness_us() const { return _max_lateness_us; }
+    unsigned long long late_events() const { return _late_events; }
+
+    //Lateness of every wake-up, in microseconds
+    const log_histogram<>& wake_lateness() const { return _wake_lateness; }
+
+    CLOCK& clock() { return _clock; }
+};
+
+#endif // DISCO_REALTIME_RUNNER_HPP
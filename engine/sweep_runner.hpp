@@ -0,0 +1,58 @@
+/**
+* ARSLab - Carleton University
+*
+* Sweep runner:
+* Runs many independent simulations thread-per-core. Each run builds its
+* own models and writes only its own result slot, so runs share no
+* mutable state; the caller merges the results afterwards.
+*/
+
+#ifndef DISCO_SWEEP_RUNNER_HPP
+#define DISCO_SWEEP_RUNNER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/*
+* Calls job(run, results[run]) for every run in [0, runs) using up to
+* threads threads (0: one per core). The first exception thrown by a job
+* is rethrown once every thread has stopped.
+*/
+template<typename RESULT, typename JOB>
+std::vector<RESULT> run_sweep(size_t runs, unsigned int threads, JOB job) {
+    std::vector<RESULT> results(runs);
+    std::vector<std::exception_ptr> errors(runs);
+    std::atomic<size_t> next_run(0);
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned int) std::min<size_t>(threads, std::max<size_t>(runs, 1));
+
+    auto worker = [&]() {
+        for (size_t run = next_run++; run < runs; run = next_run++) {
+            try {
+                job(run, results[run]);
+            } catch (...) {
+                errors[run] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return results;
+}
+
+#endif // DISCO_SWEEP_RUNNER_HPP
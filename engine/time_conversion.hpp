@@ -0,0 +1,113 @@
+/**
+* ARSLab - Carleton University
+*
+* Time conversion:
+* Maps simulation times to and from integer nanoseconds. The generic
+* version goes through the time type's text form (hh:mm:ss:mmm[:uuu[:nnn]]),
+* so it works with NDTime; integer time types can specialize it.
+* count_nanoseconds gives the same count without formatting, for code that
+* converts on every event.
+*/
+
+#ifndef DISCO_TIME_CONVERSION_HPP
+#define DISCO_TIME_CONVERSION_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <string>
+
+template<typename TIME>
+struct time_conversion {
+
+    static constexpr int64_t infinity = std::numeric_limits<int64_t>::max();
+
+    /*
+    * Nanoseconds since time zero (infinity for TIME::infinity()).
+    * If fields is given, it receives how many colon separated fields the
+    * time prints with, so from_nanoseconds can rebuild the same text.
+    */
+    static int64_t to_nanoseconds(const TIME& t, int* fields = nullptr) {
+        static const int64_t field_ns[] = {3600000000000LL, 60000000000LL, 1000000000LL, 1000000LL, 1000LL, 1LL};
+
+        std::ostringstream oss;
+        oss << t;
+        const std::string text = oss.str();
+
+        int64_t ns = 0;
+        int field = 0;
+        int64_t value = 0;
+        bool digits = false;
+
+        for (char c : text) {
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                digits = true;
+            } else if (c == ':' && digits) {
+                if (field < 6) ns += value * field_ns[field];
+                field++;
+                value = 0;
+                digits = false;
+            } else {
+                //Anything else (e.g. "inf") is not a finite time
+                return infinity;
+            }
+        }
+        if (!digits) return infinity;
+        if (field < 6) ns += value * field_ns[field];
+        field++;
+
+        if (fields) *fields = field;
+        return ns;
+    }
+
+    /*
+    * The same count without formatting or heap use, for per-event paths:
+    * t is taken apart into power-of-two nanosecond durations, built once
+    * from text on first use. A few dozen additions and comparisons of TIME.
+    */
+    static int64_t count_nanoseconds(const TIME& t) {
+        static constexpr int steps = 48; //the largest, 2^47 ns, is about 39 hours
+        struct ladder {
+            TIME step[steps];
+
+            ladder() {
+                for (int k = 0; k < steps; k++) step[k] = from_nanoseconds(1LL << k, 6);
+            }
+        };
+        static const ladder durations;
+
+        if (!(t < TIME::infinity())) return infinity;
+        TIME sum{0};
+        int64_t ns = 0;
+        while (!(t < sum + durations.step[steps - 1])) {
+            sum = sum + durations.step[steps - 1];
+            ns += 1LL << (steps - 1);
+        }
+        for (int k = steps - 2; k >= 0; k--) {
+            const TIME next = sum + durations.step[k];
+            if (!(t < next)) {
+                sum = next;
+                ns += 1LL << k;
+            }
+        }
+        return ns;
+    }
+
+    static TIME from_nanoseconds(int64_t ns, int fields = 4) {
+        if (ns == infinity) return TIME::infinity();
+
+        char text[48];
+        int len = snprintf(text, sizeof(text), "%02lld:%02lld:%02lld", (long long) (ns / 3600000000000LL),
+                           (long long) (ns / 60000000000LL % 60), (long long) (ns / 1000000000LL % 60));
+
+        const int64_t sub_second[] = {ns / 1000000 % 1000, ns / 1000 % 1000, ns % 1000};
+        for (int field = 3; field < fields && field < 6; field++) {
+            len += snprintf(text + len, sizeof(text) - len, ":%03lld", (long long) sub_second[field - 3]);
+        }
+        return TIME(text);
+    }
+};
+
+#endif // DISCO_TIME_CONVERSION_HPP
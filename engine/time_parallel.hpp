@@ -0,0 +1,118 @@
+/**
+* ARSLab - Carleton University
+*
+* Time-parallel runner:
+* Splits [start, horizon) into equal segments and runs them side by side,
+* each from a checkpoint snapshot (engine/checkpoint.hpp) of the state it
+* is predicted to start from. Once they are done, segment k is accepted if
+* its start snapshot is byte for byte the end snapshot of segment k - 1.
+* The segments that are not are run again from their predecessor's end,
+* again side by side, until every segment is accepted. Each round accepts
+* at least its first re-run segment, so there are at most as many rounds
+* as segments, and the result is the one a sequential run gives.
+*
+* The prediction is the caller's: the better it is, the fewer segments run
+* twice. Snapshots of the DISCO atomics are a few hundred bytes, so
+* predicting, passing and comparing them costs little next to a segment.
+*/
+
+#ifndef DISCO_TIME_PARALLEL_HPP
+#define DISCO_TIME_PARALLEL_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sweep_runner.hpp"
+#include "time_conversion.hpp"
+
+//Where the segment running on this thread logs
+struct segment_sink_provider {
+    inline static thread_local std::ostream* stream = nullptr;
+
+    static std::ostream& sink() {
+        return *stream;
+    }
+};
+
+struct segment_result {
+    std::string end;                    //snapshot at the end of the segment
+    unsigned long long transitions = 0;
+};
+
+struct time_parallel_report {
+    size_t segments = 0;
+    size_t rounds = 0;
+    size_t runs = 0;                    //segment runs, re-runs included
+    unsigned long long transitions = 0; //of the accepted runs
+};
+
+//The segment boundaries: segments + 1 times from start to horizon
+template<typename TIME>
+std::vector<TIME> segment_boundaries(const TIME& start, const TIME& horizon, size_t segments) {
+    using conversion=time_conversion<TIME>;
+    int fields = 4;
+    const int64_t from = conversion::to_nanoseconds(start);
+    const int64_t to = conversion::to_nanoseconds(horizon, &fields);
+    if (segments == 0 || to == conversion::infinity || to <= from) {
+        throw std::invalid_argument("Time-parallel runs need a finite horizon after the start and at least one segment");
+    }
+
+    std::vector<TIME> boundaries;
+    for (size_t k = 0; k <= segments; k++) {
+        boundaries.push_back(conversion::from_nanoseconds(from + (int64_t) ((to - from) * (long double) k / segments), fields));
+    }
+    return boundaries;
+}
+
+/*
+* predicted[k] is the snapshot segment k is predicted to start from
+* (predicted[0] is ignored: segment 0 starts fresh). segment(k, start,
+* from, until) builds TOP, restores start unless k is 0, runs it from
+* `from` until `until` and returns the snapshot at `until`; a re-run must
+* overwrite the outputs of the earlier run of k.
+*/
+template<typename TIME, typename SEGMENT>
+time_parallel_report run_time_parallel(const std::vector<TIME>& boundaries, std::vector<std::string> predicted,
+                                       unsigned int threads, SEGMENT segment) {
+    const size_t segments = boundaries.size() - 1;
+    predicted.resize(segments);
+
+    time_parallel_report report;
+    report.segments = segments;
+    std::vector<segment_result> results(segments);
+
+    std::vector<size_t> pending;
+    for (size_t k = 0; k < segments; k++) {
+        pending.push_back(k);
+    }
+
+    while (!pending.empty()) {
+        auto done = run_sweep<segment_result>(pending.size(), threads, [&](size_t run, segment_result& result) {
+            const size_t k = pending[run];
+            result = segment(k, predicted[k], boundaries[k], boundaries[k + 1]);
+        });
+        for (size_t run = 0; run < pending.size(); run++) {
+            results[pending[run]] = std::move(done[run]);
+        }
+        report.rounds++;
+        report.runs += pending.size();
+
+        pending.clear();
+        for (size_t k = 1; k < segments; k++) {
+            if (predicted[k] != results[k - 1].end) {
+                predicted[k] = results[k - 1].end;
+                pending.push_back(k);
+            }
+        }
+    }
+
+    for (const segment_result& result : results) {
+        report.transitions += result.transitions;
+    }
+    return report;
+}
+
+#endif // DISCO_TIME_PARALLEL_HPP
@@ -0,0 +1,91 @@
+/**
+* ARSLab - Carleton University
+*
+* Transition counter:
+* Decorates an atomic model so every internal, external and confluence
+* transition it executes is counted. Used by the batch runner to report
+* simulator throughput.
+*/
+
+#ifndef DISCO_TRANSITION_COUNTER_HPP
+#define DISCO_TRANSITION_COUNTER_HPP
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <utility>
+
+using namespace cadmium;
+
+//Counts are per thread so independent simulations can run side by side
+struct transition_counter {
+    inline static thread_local unsigned long long internal = 0;
+    inline static thread_local unsigned long long external = 0;
+    inline static thread_local unsigned long long confluence = 0;
+
+    static unsigned long long total() {
+        return internal + external + confluence;
+    }
+
+    static void reset() {
+        internal = 0;
+        external = 0;
+        confluence = 0;
+    }
+};
+
+//Counts made on one thread, to be moved to another (e.g. from a pool thread to the thread running TOP)
+struct transition_counts {
+    unsigned long long internal = 0;
+    unsigned long long external = 0;
+    unsigned long long confluence = 0;
+
+    //This thread's counts, which start again from zero
+    static transition_counts take() {
+        transition_counts counts{transition_counter::internal, transition_counter::external, transition_counter::confluence};
+        transition_counter::reset();
+        return counts;
+    }
+
+    //Adds them to this thread's counts
+    void add() const {
+        transition_counter::internal += internal;
+        transition_counter::external += external;
+        transition_counter::confluence += confluence;
+    }
+};
+
+/*
+* Usage: counted<Switch>::model can be given anywhere Switch is expected,
+* e.g. make_dynamic_atomic_model<counted<Switch>::model, TIME>("switch1").
+*/
+template<template<typename> class ATOMIC>
+struct counted {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+
+    public:
+        using base::base;
+
+        // internal transition
+        void internal_transition() {
+            ++transition_counter::internal;
+            base::internal_transition();
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            ++transition_counter::external;
+            base::external_transition(e, std::move(mbs));
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            ++transition_counter::confluence;
+            base::confluence_transition(e, std::move(mbs));
+        }
+    };
+};
+
+#endif // DISCO_TRANSITION_COUNTER_HPP
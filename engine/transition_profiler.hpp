@@ -0,0 +1,237 @@
+/**
+* ARSLab - Carleton University
+*
+* Transition profiler:
+* Decorates an atomic model so the calls to internal_transition,
+* external_transition, confluence_transition, output and time_advance are
+* counted and timed per model; profile_report::print lists them hottest
+* first. Build with -DDISCO_PROFILE to enable it. Otherwise profiled<ATOMIC>
+* is ATOMIC itself and the report prints nothing, so it can stay in any
+* build. The profile is not synchronized: models must run on one thread.
+*
+* Host times come from steady_clock, target times from the Cortex-M cycle
+* counter (DWT).
+*/
+
+#ifndef DISCO_TRANSITION_PROFILER_HPP
+#define DISCO_TRANSITION_PROFILER_HPP
+
+#include <iostream>
+
+#ifdef DISCO_PROFILE
+
+#include <cadmium/modeling/message_bag.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <utility>
+
+#ifdef RT_ARM_MBED
+#include "../mbed.h"
+#else
+#include <chrono>
+#endif
+
+#include "model_scope.hpp"
+#include "model_table.hpp"
+
+using namespace cadmium;
+
+#ifndef DISCO_PROFILE_MAX_MODELS
+#define DISCO_PROFILE_MAX_MODELS 8
+#endif
+
+enum class profiled_call { internal, external, confluence, output, time_advance, count };
+
+struct call_profile {
+    unsigned long long calls = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    void add(uint64_t ns) {
+        calls++;
+        total_ns += ns;
+        if (ns > max_ns) max_ns = ns;
+    }
+};
+
+class profile_clock {
+public:
+    #ifdef RT_ARM_MBED
+    using ticks=uint32_t;
+
+    static ticks now() {
+        static bool started = false;
+        if (!started) {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CYCCNT = 0;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+            started = true;
+        }
+        return DWT->CYCCNT;
+    }
+
+    //Unsigned difference, so one counter wrap between start and end is harmless
+    static uint64_t nanoseconds_since(ticks start) {
+        return (uint64_t) (uint32_t) (now() - start) * 1000 / (SystemCoreClock / 1000000);
+    }
+    #else
+    using ticks=std::chrono::steady_clock::time_point;
+
+    static ticks now() {
+        return std::chrono::steady_clock::now();
+    }
+
+    static uint64_t nanoseconds_since(ticks start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now() - start).count();
+    }
+    #endif
+};
+
+class profile_report {
+public:
+    struct model_profile {
+        call_profile calls[(int) profiled_call::count];
+    };
+
+private:
+    inline static model_table<model_profile, DISCO_PROFILE_MAX_MODELS> _table;
+
+public:
+    //Profile of the model with this id (models past the table share "(others)")
+    static model_profile* profile_for(const char* id) {
+        return _table.stats_for(id);
+    }
+
+    static void reset() {
+        _table.reset();
+    }
+
+    //Hotspot table: one row per model and call, by total time
+    static void print(std::ostream& os) {
+        static const char* call_names[] = {"internal", "external", "confluence", "output", "time_advance"};
+
+        struct row {
+            const char* model;
+            const char* call;
+            const call_profile* profile;
+        };
+        row rows[DISCO_PROFILE_MAX_MODELS * (int) profiled_call::count];
+        int used_rows = 0;
+        uint64_t total_ns = 0;
+
+        for (int i = 0; i < _table.size(); i++) {
+            for (int call = 0; call < (int) profiled_call::count; call++) {
+                const call_profile& profile = _table[i].stats.calls[call];
+                if (profile.calls == 0) continue;
+                rows[used_rows++] = {_table[i].id, call_names[call], &profile};
+                total_ns += profile.total_ns;
+            }
+        }
+        std::sort(rows, rows + used_rows, [](const row& a, const row& b) {
+            return a.profile->total_ns > b.profile->total_ns;
+        });
+
+        const std::ios_base::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+
+        os << std::left << std::setw(24) << "Hotspots" << std::setw(14) << "call" << std::right
+           << std::setw(12) << "calls" << std::setw(12) << "total ms" << std::setw(8) << "%"
+           << std::setw(12) << "mean us" << std::setw(12) << "max us" << "\n";
+        os << std::fixed;
+        for (int i = 0; i < used_rows; i++) {
+            const call_profile& profile = *rows[i].profile;
+            os << std::left << std::setw(24) << rows[i].model << std::setw(14) << rows[i].call << std::right
+               << std::setw(12) << profile.calls
+               << std::setw(12) << std::setprecision(3) << profile.total_ns / 1e6
+               << std::setw(8) << std::setprecision(1) << (total_ns ? 100.0 * profile.total_ns / total_ns : 0.0)
+               << std::setw(12) << std::setprecision(3) << profile.total_ns / 1e3 / profile.calls
+               << std::setw(12) << profile.max_ns / 1e3 << "\n";
+        }
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+};
+
+/*
+* Usage: profiled<Arbiter>::model, built inside a model_scope naming it
+* (make_disco_top does this for every atomic).
+*/
+template<template<typename> class ATOMIC>
+struct profiled {
+
+    template<typename TIME>
+    class model : public ATOMIC<TIME> {
+        using base=ATOMIC<TIME>;
+        using input_bags=typename make_message_bags<typename base::input_ports>::type;
+        using output_bags=typename make_message_bags<typename base::output_ports>::type;
+
+        profile_report::model_profile* _profile;
+
+        call_profile& profile_of(profiled_call call) const {
+            return _profile->calls[(int) call];
+        }
+
+    public:
+        template<typename... ARGS>
+        model(ARGS&&... args) : base(std::forward<ARGS>(args)...) {
+            _profile = profile_report::profile_for(model_scope::current());
+        }
+
+        // internal transition
+        void internal_transition() {
+            const profile_clock::ticks start = profile_clock::now();
+            base::internal_transition();
+            profile_of(profiled_call::internal).add(profile_clock::nanoseconds_since(start));
+        }
+
+        // external transition
+        void external_transition(TIME e, input_bags mbs) {
+            const profile_clock::ticks start = profile_clock::now();
+            base::external_transition(e, std::move(mbs));
+            profile_of(profiled_call::external).add(profile_clock::nanoseconds_since(start));
+        }
+
+        // confluence transition
+        void confluence_transition(TIME e, input_bags mbs) {
+            const profile_clock::ticks start = profile_clock::now();
+            base::confluence_transition(e, std::move(mbs));
+            profile_of(profiled_call::confluence).add(profile_clock::nanoseconds_since(start));
+        }
+
+        // output function
+        output_bags output() const {
+            const profile_clock::ticks start = profile_clock::now();
+            output_bags bags = base::output();
+            profile_of(profiled_call::output).add(profile_clock::nanoseconds_since(start));
+            return bags;
+        }
+
+        // time_advance function
+        TIME time_advance() const {
+            const profile_clock::ticks start = profile_clock::now();
+            TIME ta = base::time_advance();
+            profile_of(profiled_call::time_advance).add(profile_clock::nanoseconds_since(start));
+            return ta;
+        }
+    };
+};
+
+#else
+
+//Profiling disabled: the atomic itself, and an empty report
+template<template<typename> class ATOMIC>
+struct profiled {
+    template<typename TIME>
+    using model = ATOMIC<TIME>;
+};
+
+struct profile_report {
+    static void reset() {}
+    static void print(std::ostream&) {}
+};
+
+#endif // DISCO_PROFILE
+
+#endif // DISCO_TRANSITION_PROFILER_HPP
@@ -0,0 +1,131 @@
+/**
+* ARSLab - Carleton University
+*
+* Wake-up clocks:
+* How realtime_runner waits for the next event. A clock counts
+* microseconds from start() and sleep_until(due) returns once due has
+* passed. The board's inputs are polled by their atomics, so nothing ends
+* a sleep early.
+*
+* steady_sleep_clock   host: std::chrono::steady_clock and sleep_until
+* tickless_clock       target: a low-power timeout for the next event, the
+*                      core asleep until it fires
+* virtual_clock        host stand-in for tickless_clock: sleeps take no wall
+*                      time, wake-ups come late by a configurable latency
+*                      and jitter, and the sleep pattern is counted
+*/
+
+#ifndef DISCO_WAKEUP_CLOCKS_HPP
+#define DISCO_WAKEUP_CLOCKS_HPP
+
+#include <cstdint>
+
+#ifdef RT_ARM_MBED
+#include "../mbed.h"
+#else
+#include <chrono>
+#include <random>
+#include <thread>
+#endif
+
+#ifdef RT_ARM_MBED
+
+class tickless_clock {
+    //Keep counting and waking in deep sleep where the target has a low-power ticker
+    #if DEVICE_LPTICKER
+    LowPowerTimer _timer;
+    LowPowerTimeout _wakeup;
+    #else
+    Timer _timer;
+    Timeout _wakeup;
+    #endif
+    volatile bool _due = false;
+
+    void due() {
+        _due = true;
+    }
+
+public:
+    void start() {
+        _timer.reset();
+        _timer.start();
+    }
+
+    int64_t now_us() {
+        return (int64_t) _timer.read_high_resolution_us();
+    }
+
+    void sleep_until(int64_t due_us) {
+        const int64_t left = due_us - now_us();
+        if (left <= 0) return;
+
+        _due = false;
+        _wakeup.attach_us(callback(this, &tickless_clock::due), (us_timestamp_t) left);
+        //Other interrupts (e.g. the serial port) wake the core too; only the timeout ends the wait
+        while (!_due) {
+            sleep();
+        }
+        _wakeup.detach();
+    }
+};
+
+#else
+
+class steady_sleep_clock {
+    std::chrono::steady_clock::time_point _origin;
+
+public:
+    void start() {
+        _origin = std::chrono::steady_clock::now();
+    }
+
+    int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _origin).count();
+    }
+
+    void sleep_until(int64_t due_us) {
+        std::this_thread::sleep_until(_origin + std::chrono::microseconds(due_us));
+    }
+};
+
+class virtual_clock {
+    int64_t _now_us = 0;
+    int64_t _latency_us;
+    int64_t _jitter_us;
+    std::minstd_rand _random;
+
+    unsigned long long _sleeps = 0;
+    int64_t _asleep_us = 0;
+
+public:
+    //Every wake-up comes latency_us plus up to jitter_us (uniform, seeded) after it was due
+    virtual_clock(int64_t latency_us = 0, int64_t jitter_us = 0, unsigned int seed = 1)
+        : _latency_us(latency_us), _jitter_us(jitter_us), _random(seed) {}
+
+    void start() {
+        _now_us = 0;
+        _sleeps = 0;
+        _asleep_us = 0;
+    }
+
+    int64_t now_us() const {
+        return _now_us;
+    }
+
+    void sleep_until(int64_t due_us) {
+        if (due_us <= _now_us) return;
+
+        const int64_t jitter = _jitter_us > 0 ? (int64_t) (_random() % (uint64_t) (_jitter_us + 1)) : 0;
+        _sleeps++;
+        _asleep_us += due_us - _now_us; //waking up (latency and jitter) keeps the core busy
+        _now_us = due_us + _latency_us + jitter;
+    }
+
+    //Sleeps so far, and the time spent asleep up to each due time
+    unsigned long long sleeps() const { return _sleeps; }
+    int64_t asleep_us() const { return _asleep_us; }
+};
+
+#endif // RT_ARM_MBED
+
+#endif // DISCO_WAKEUP_CLOCKS_HPP
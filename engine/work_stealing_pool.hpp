@@ -0,0 +1,190 @@
+/**
+* ARSLab - Carleton University
+*
+* Work-stealing pool:
+* run(tasks, task) calls task(i) for every i in [0, tasks) on the pool's
+* threads and the calling thread, and returns once all are done. The
+* indices are split into one contiguous range per thread; a thread takes
+* indices from the front of its own range and, once it is empty, steals
+* the back half of another thread's. Both are a single compare-and-swap
+* on the range, so an uneven phase (one slow model, many quick ones)
+* still keeps every thread busy.
+*
+* Between runs the threads spin briefly, then sleep until the next run.
+* The first exception thrown by a task is rethrown by run().
+*/
+
+#ifndef DISCO_WORK_STEALING_POOL_HPP
+#define DISCO_WORK_STEALING_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class work_stealing_pool {
+    //[begin, end) of the indices left to a thread, packed so one CAS updates both
+    struct alignas(64) task_range {
+        std::atomic<uint64_t> range{0};
+
+        static uint64_t pack(uint32_t begin, uint32_t end) {
+            return ((uint64_t) begin << 32) | end;
+        }
+    };
+
+    std::vector<std::thread> _threads;
+    std::unique_ptr<task_range[]> _ranges;
+    unsigned int _size;
+
+    //The current run
+    void (*_call)(const void*, size_t) = nullptr;
+    const void* _task = nullptr;
+    std::atomic<size_t> _remaining{0};
+    std::atomic<unsigned int> _busy{0};
+    std::exception_ptr _error;
+    std::atomic<bool> _failed{false};
+    std::atomic<unsigned long long> _steals{0};
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::atomic<uint64_t> _generation{0};
+    bool _stop = false;
+
+    bool take(unsigned int self, size_t& index) {
+        std::atomic<uint64_t>& range = _ranges[self].range;
+        uint64_t r = range.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t begin = (uint32_t) (r >> 32), end = (uint32_t) r;
+            if (begin >= end) return false;
+            if (range.compare_exchange_weak(r, task_range::pack(begin + 1, end), std::memory_order_acq_rel)) {
+                index = begin;
+                return true;
+            }
+        }
+    }
+
+    //Moves the back half of another thread's range to self's (which is empty)
+    bool steal(unsigned int self) {
+        for (unsigned int k = 1; k < _size; k++) {
+            std::atomic<uint64_t>& victim = _ranges[(self + k) % _size].range;
+            uint64_t r = victim.load(std::memory_order_acquire);
+            while (true) {
+                const uint32_t begin = (uint32_t) (r >> 32), end = (uint32_t) r;
+                if (begin >= end) break;
+                const uint32_t half = (end - begin + 1) / 2;
+                if (victim.compare_exchange_weak(r, task_range::pack(begin, end - half), std::memory_order_acq_rel)) {
+                    _ranges[self].range.store(task_range::pack(end - half, end), std::memory_order_release);
+                    _steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned int self) {
+        size_t index;
+        do {
+            while (take(self, index)) {
+                if (!_failed.load(std::memory_order_relaxed)) {
+                    try {
+                        _call(_task, index);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (!_failed.exchange(true)) _error = std::current_exception();
+                    }
+                }
+                _remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        } while (steal(self));
+    }
+
+    void worker(unsigned int self) {
+        uint64_t seen = 0;
+        while (true) {
+            //Spin a little: phases of one simulated time follow each other quickly
+            for (int spin = 0; spin < 4096 && _generation.load(std::memory_order_acquire) == seen; spin++) {
+                std::this_thread::yield();
+            }
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [&]() { return _stop || _generation.load(std::memory_order_acquire) != seen; });
+                if (_stop) return;
+            }
+            seen = _generation.load(std::memory_order_acquire);
+            work(self);
+            _busy.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+public:
+    //threads counts the calling thread (0: one per core)
+    explicit work_stealing_pool(unsigned int threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        _size = threads;
+        _ranges.reset(new task_range[threads]);
+        for (unsigned int i = 1; i < threads; i++) {
+            _threads.emplace_back(&work_stealing_pool::worker, this, i);
+        }
+    }
+
+    ~work_stealing_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    unsigned int size() const {
+        return _size;
+    }
+
+    //Ranges taken from another thread so far
+    unsigned long long steals() const {
+        return _steals.load(std::memory_order_relaxed);
+    }
+
+    template<typename TASK>
+    void run(size_t tasks, const TASK& task) {
+        if (_size == 1 || tasks < 2) {
+            for (size_t i = 0; i < tasks; i++) task(i);
+            return;
+        }
+
+        _call = [](const void* t, size_t i) { (*static_cast<const TASK*>(t))(i); };
+        _task = &task;
+        _error = nullptr;
+        _failed.store(false, std::memory_order_relaxed);
+        _remaining.store(tasks, std::memory_order_relaxed);
+        _busy.store(_size - 1, std::memory_order_relaxed);
+        for (unsigned int i = 0; i < _size; i++) {
+            _ranges[i].range.store(task_range::pack((uint32_t) (tasks * i / _size), (uint32_t) (tasks * (i + 1) / _size)), std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+        _wake.notify_all();
+
+        work(0);
+        //Every thread must be done with this run before the next one resets the ranges
+        while (_remaining.load(std::memory_order_acquire) != 0 || _busy.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        if (_failed.load(std::memory_order_acquire)) std::rethrow_exception(_error);
+    }
+};
+
+#endif // DISCO_WORK_STEALING_POOL_HPP
@@ -0,0 +1,169 @@
+/**
+* ARSLab - Carleton University
+*
+* Asynchronous log sink:
+* An ostream whose bytes are handed to a background writer thread through
+* a bounded lock-free ring (data_structures/spsc_ring.hpp), so the
+* simulation thread never waits on file I/O. Return it from a sink
+* provider in place of the log file; the writer thread writes the exact
+* same bytes, in order, to the wrapped stream.
+*
+* When the ring is full the back-pressure policy decides what happens:
+*   block - the simulation waits for the writer (output stays complete)
+*   drop  - the overflowing bytes are discarded and counted
+*/
+
+#ifndef DISCO_ASYNC_SINK_HPP
+#define DISCO_ASYNC_SINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "../data_structures/spsc_ring.hpp"
+
+enum class back_pressure { block, drop };
+
+class async_log_buffer : public std::streambuf {
+    spsc_ring _ring;
+    std::ostream& _target;
+    back_pressure _policy;
+
+    //Formatted text is batched here before it enters the ring
+    std::vector<char> _chunk;
+
+    unsigned long long _dropped_bytes;
+    unsigned long long _stalls;
+    std::atomic<bool> _running;
+    std::thread _writer;
+
+    void push(const char* data, size_t size) {
+        while (size) {
+            size_t n = _ring.write(data, size);
+            data += n;
+            size -= n;
+
+            if (size) {
+                if (_policy == back_pressure::drop) {
+                    _dropped_bytes += size;
+                    return;
+                }
+                _stalls++;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void push_chunk() {
+        push(pbase(), pptr() - pbase());
+        setp(_chunk.data(), _chunk.data() + _chunk.size());
+    }
+
+    //Writer thread: drains the ring until closed and empty
+    void drain() {
+        std::vector<char> out(1 << 16);
+
+        while (true) {
+            size_t n = _ring.read(out.data(), out.size());
+            if (n) {
+                _target.write(out.data(), n);
+            } else if (_running.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            } else {
+                //Everything pushed before close() is visible now
+                while ((n = _ring.read(out.data(), out.size()))) {
+                    _target.write(out.data(), n);
+                }
+                break;
+            }
+        }
+        _target.flush();
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        push_chunk();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (n <= epptr() - pptr()) {
+            traits_type::copy(pptr(), s, n);
+            pbump((int) n);
+        } else {
+            push_chunk();
+            push(s, n);
+        }
+        return n;
+    }
+
+    //Flushing only hands the text to the writer thread
+    int sync() override {
+        push_chunk();
+        return 0;
+    }
+
+public:
+    explicit async_log_buffer(std::ostream& target, size_t ring_bytes = 1 << 22,
+                              back_pressure policy = back_pressure::block, size_t chunk_bytes = 1 << 14) :
+        _ring(ring_bytes),
+        _target(target),
+        _policy(policy),
+        _chunk(chunk_bytes),
+        _dropped_bytes(0),
+        _stalls(0),
+        _running(true),
+        _writer(&async_log_buffer::drain, this) {
+        setp(_chunk.data(), _chunk.data() + _chunk.size());
+    }
+
+    ~async_log_buffer() {
+        close();
+    }
+
+    //Writes out everything logged so far and stops the writer thread
+    void close() {
+        if (!_writer.joinable()) return;
+        push_chunk();
+        _running.store(false, std::memory_order_release);
+        _writer.join();
+    }
+
+    unsigned long long dropped_bytes() const {
+        return _dropped_bytes;
+    }
+
+    //Times the simulation had to wait for the writer (block policy)
+    unsigned long long stalls() const {
+        return _stalls;
+    }
+};
+
+class async_log_stream : public std::ostream {
+    async_log_buffer _buffer;
+
+public:
+    explicit async_log_stream(std::ostream& target, size_t ring_bytes = 1 << 22,
+                              back_pressure policy = back_pressure::block) :
+        std::ostream(nullptr),
+        _buffer(target, ring_bytes, policy) {
+        rdbuf(&_buffer);
+    }
+
+    void close() {
+        _buffer.close();
+    }
+
+    const async_log_buffer& buffer() const {
+        return _buffer;
+    }
+};
+
+#endif // DISCO_ASYNC_SINK_HPP
@@ -0,0 +1,166 @@
+/**
+* ARSLab - Carleton University
+*
+* Binary event trace:
+* Drop-in replacement for cadmium::logger::logger<SOURCE, formatter, SINK>
+* that writes fixed-size records instead of formatted text. Model names
+* are interned into a dictionary that travels inline with the trace, and
+* tools/trace_decoder.cpp turns a trace back into the text log.
+*
+* File layout:
+*   "DTRC" + uint32 version
+*   records: record_header + payload_size bytes of payload
+*/
+
+#ifndef DISCO_BINARY_LOGGER_HPP
+#define DISCO_BINARY_LOGGER_HPP
+
+#include <cadmium.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+#include "../engine/time_conversion.hpp"
+
+namespace disco_trace {
+
+    const char magic[4] = {'D', 'T', 'R', 'C'};
+    const uint32_t version = 1;
+
+    struct record_header {
+        int64_t time;           // nanoseconds, see time_conversion
+        uint16_t model;         // interned model id, 0 when the event has none
+        uint8_t event;          // index in traced_events, or dictionary_event
+        uint8_t time_fields;    // fields the time printed with
+        uint32_t payload_size;  // bytes following the header
+    };
+    static_assert(sizeof(record_header) == 16, "trace records must stay 16 bytes + payload");
+
+    //Declares a model name: model holds the new id, the payload the name
+    const uint8_t dictionary_event = 0xFF;
+
+    //Parameters the engine logs the event with
+    enum class event_shape { time, time_model_text };
+
+    template<typename SOURCE, typename EVENT, event_shape SHAPE>
+    struct traced_event {
+        using source=SOURCE;
+        using event=EVENT;
+        static constexpr event_shape shape = SHAPE;
+    };
+
+    //Events that can be traced; a record's event byte is the index in this list
+    using traced_events=std::tuple<
+        traced_event<cadmium::logger::logger_global_time, cadmium::logger::run_global_time, event_shape::time>,
+        traced_event<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect, event_shape::time_model_text>,
+        traced_event<cadmium::logger::logger_state, cadmium::logger::sim_state, event_shape::time_model_text>
+    >;
+
+    //Index of SOURCE/EVENT in traced_events, -1 if it is not traced
+    template<typename SOURCE, typename EVENT, size_t I = 0>
+    constexpr int event_code() {
+        if constexpr (I == std::tuple_size<traced_events>::value) {
+            return -1;
+        } else {
+            using entry=typename std::tuple_element<I, traced_events>::type;
+            if (std::is_same<typename entry::source, SOURCE>::value && std::is_same<typename entry::event, EVENT>::value) {
+                return I;
+            }
+            return event_code<SOURCE, EVENT, I + 1>();
+        }
+    }
+
+    //Encoder state shared by every binary logger writing to the same sink
+    template<typename TIME>
+    class writer {
+        std::unordered_map<std::string, uint16_t> _models;
+        bool _started = false;
+
+        //Times repeat for every event of a step, so only convert on change
+        bool _has_time = false;
+        TIME _last_time;
+        int64_t _last_ns = 0;
+        int _last_fields = 0;
+
+        void write_record(std::ostream& os, uint8_t event, uint16_t model, const TIME& t, const char* payload, uint32_t size) {
+            if (!_started) {
+                os.write(magic, sizeof(magic));
+                os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+                _started = true;
+            }
+            if (!_has_time || !(t == _last_time)) {
+                _last_ns = time_conversion<TIME>::to_nanoseconds(t, &_last_fields);
+                _last_time = t;
+                _has_time = true;
+            }
+
+            record_header header;
+            header.time = _last_ns;
+            header.model = model;
+            header.event = event;
+            header.time_fields = (uint8_t) _last_fields;
+            header.payload_size = size;
+
+            os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (size) os.write(payload, size);
+        }
+
+        uint16_t intern(std::ostream& os, const TIME& t, const std::string& model_id) {
+            auto found = _models.find(model_id);
+            if (found != _models.end()) return found->second;
+
+            uint16_t id = (uint16_t) (_models.size() + 1);
+            _models.emplace(model_id, id);
+            write_record(os, dictionary_event, id, t, model_id.data(), (uint32_t) model_id.size());
+            return id;
+        }
+
+    public:
+        void write(std::ostream& os, uint8_t event, const TIME& t) {
+            write_record(os, event, 0, t, nullptr, 0);
+        }
+
+        void write(std::ostream& os, uint8_t event, const TIME& t, const std::string& model_id, const std::string& text) {
+            uint16_t model = intern(os, t, model_id);
+            write_record(os, event, model, t, text.data(), (uint32_t) text.size());
+        }
+    };
+
+    template<typename SINK_PROVIDER, typename TIME>
+    writer<TIME>& writer_for() {
+        static writer<TIME> w;
+        return w;
+    }
+}
+
+/*
+* Same shape as cadmium::logger::logger; combine several of them with
+* cadmium::logger::multilogger. SINK_PROVIDER::sink() should be opened in
+* binary mode.
+*/
+template<typename LOGGING_SOURCE, typename SINK_PROVIDER>
+struct binary_logger {
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... ps) {
+        constexpr int code = disco_trace::event_code<DECLARED_SOURCE, EVENT>();
+        if constexpr (std::is_same<LOGGING_SOURCE, DECLARED_SOURCE>::value && code >= 0) {
+            record((uint8_t) code, ps...);
+        }
+    }
+
+private:
+    template<typename TIME>
+    static void record(uint8_t code, const TIME& t) {
+        disco_trace::writer_for<SINK_PROVIDER, TIME>().write(SINK_PROVIDER::sink(), code, t);
+    }
+
+    template<typename TIME>
+    static void record(uint8_t code, const TIME& t, const std::string& model_id, const std::string& text) {
+        disco_trace::writer_for<SINK_PROVIDER, TIME>().write(SINK_PROVIDER::sink(), code, t, model_id, text);
+    }
+};
+
+#endif // DISCO_BINARY_LOGGER_HPP
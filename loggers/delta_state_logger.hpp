@@ -0,0 +1,86 @@
+/**
+* ARSLab - Carleton University
+*
+* Delta state logging:
+* delta_state_logger<TIME, LOGGER> passes every event on to LOGGER except
+* sim_state. A model's state is passed on only when its text differs from
+* the last one written for that model. Every keyframe_period of simulated
+* time, before the first state event due, the last state of every model
+* seen so far is written again as a keyframe. A model's state at time T is
+* then its last state line at or before T, and no more than one period of
+* log has to be read back to find it.
+*
+* The lines keep LOGGER's format (e.g. cadmium's "State for model ... is
+* ..."), so the delta log can be read with the usual tools.
+*/
+
+#ifndef DISCO_DELTA_STATE_LOGGER_HPP
+#define DISCO_DELTA_STATE_LOGGER_HPP
+
+#include <cadmium.h>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+template<typename TIME, typename LOGGER>
+struct delta_state_logger {
+    inline static TIME keyframe_period = TIME("00:10:00:000");
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::sim_state>::value) {
+            log_state<DECLARED_SOURCE>(params...);
+        } else {
+            LOGGER::template log<DECLARED_SOURCE, EVENT>(params...);
+        }
+    }
+
+    //State lines written (keyframes included) and left out as unchanged
+    static unsigned long long written() { return _written; }
+    static unsigned long long unchanged() { return _unchanged; }
+
+    static void reset() {
+        _last.clear();
+        _models.clear();
+        _next_keyframe = TIME::zero();
+        _written = 0;
+        _unchanged = 0;
+    }
+
+private:
+    inline static std::unordered_map<std::string, std::string> _last;
+    inline static std::vector<std::string> _models; //in order of first appearance
+    inline static TIME _next_keyframe = TIME::zero();
+    inline static unsigned long long _written = 0;
+    inline static unsigned long long _unchanged = 0;
+
+    template<typename DECLARED_SOURCE>
+    static void keyframe(const TIME& t) {
+        for (const std::string& id : _models) {
+            LOGGER::template log<DECLARED_SOURCE, cadmium::logger::sim_state>(t, id, _last[id]);
+            _written++;
+        }
+        _next_keyframe = t + keyframe_period;
+    }
+
+    template<typename DECLARED_SOURCE, typename ID, typename STATE>
+    static void log_state(const TIME& t, const ID& id, const STATE& state) {
+        if (!(t < _next_keyframe)) keyframe<DECLARED_SOURCE>(t);
+
+        auto last = _last.find(id);
+        if (last == _last.end()) {
+            _models.push_back(id);
+            _last.emplace(id, state);
+        } else if (last->second == state) {
+            _unchanged++;
+            return;
+        } else {
+            last->second = state;
+        }
+        LOGGER::template log<DECLARED_SOURCE, cadmium::logger::sim_state>(t, id, state);
+        _written++;
+    }
+};
+
+#endif // DISCO_DELTA_STATE_LOGGER_HPP
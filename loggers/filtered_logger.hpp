@@ -0,0 +1,94 @@
+/**
+* ARSLab - Carleton University
+*
+* Filtered logging:
+* A trace_selection names, at compile time, the models whose message and
+* state events are logged and, per model, the output ports whose messages
+* are. filtered_logger<SELECTION, LOGGER> logs through LOGGER only what the
+* selection names:
+*
+*   constexpr char arbiter1[] = "arbiter1";
+*   using lcd_only = trace_selection<model_ports<arbiter1, arbiter_defs::lcd_update_out>>;
+*   using lcd_log = filtered_logger<lcd_only, logger_top>;
+*
+* flat_runner resolves the selection against the model ids once, before the
+* run. Models that are not selected are never formatted; of a selected
+* model only the selected ports are, in the rounds they carry messages.
+* Under cadmium's runners the messages arrive already formatted, so the
+* filter can only drop whole models, and that check runs for every event.
+*
+* Other events (global time, routing, info...) are passed on unfiltered.
+*/
+
+#ifndef DISCO_FILTERED_LOGGER_HPP
+#define DISCO_FILTERED_LOGGER_HPP
+
+#include <cadmium.h>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+//The model with id MODEL; only the messages of PORTS, or of every port if none are given
+template<const char* MODEL, typename... PORTS>
+struct model_ports {
+    static bool matches(const std::string& id) {
+        return id == MODEL;
+    }
+
+    static bool all_ports() {
+        return sizeof...(PORTS) == 0;
+    }
+
+    static void add_ports(std::vector<std::type_index>& ports) {
+        (ports.push_back(typeid(PORTS)), ...);
+    }
+};
+
+template<typename... MODEL_PORTS>
+struct trace_selection {
+    static bool selects(const std::string& id) {
+        return (MODEL_PORTS::matches(id) || ...);
+    }
+
+    //The ports of model id to log; false if every port is
+    static bool selected_ports(const std::string& id, std::vector<std::type_index>& ports) {
+        bool filtered = true;
+        ([&]() {
+            if (!MODEL_PORTS::matches(id)) return;
+            if (MODEL_PORTS::all_ports()) filtered = false;
+            MODEL_PORTS::add_ports(ports);
+        }(), ...);
+        return filtered;
+    }
+};
+
+template<typename SELECTION, typename LOGGER>
+struct filtered_logger {
+    using selection=SELECTION;
+    using unfiltered=LOGGER; //for runners that apply the selection themselves
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        if constexpr (std::is_same<EVENT, cadmium::logger::sim_messages_collect>::value || std::is_same<EVENT, cadmium::logger::sim_state>::value) {
+            if (!SELECTION::selects(std::get<1>(std::tie(params...)))) return;
+        }
+        LOGGER::template log<DECLARED_SOURCE, EVENT>(params...);
+    }
+};
+
+//LOGGER's trace_selection (void if it logs every model) and the logger to use once it is applied
+template<typename LOGGER, typename = void>
+struct trace_selection_of {
+    using type=void;
+    using logger=LOGGER;
+};
+
+template<typename LOGGER>
+struct trace_selection_of<LOGGER, std::void_t<typename LOGGER::selection>> {
+    using type=typename LOGGER::selection;
+    using logger=typename LOGGER::unfiltered;
+};
+
+#endif // DISCO_FILTERED_LOGGER_HPP
@@ -0,0 +1,317 @@
+/**
+* ARSLab - Carleton University
+*
+* Flight recorder:
+* flight_recorder<TIME, TRIGGER, WINDOW> keeps the last events the engine
+* logs (global time, messages and states) in a fixed ring of fixed-size
+* records, and writes nothing until TRIGGER fires. It then keeps recording
+* until `after` more events are in, and hands the window (the `before`
+* events up to and including the trigger, and the `after` following it)
+* to WINDOW. Memory use is the ring and nothing else, however long the run.
+*
+* TRIGGER::fires(event, model, text) returns the reason it fired (shown
+* with the window) or nullptr. Triggers inside a pending window are
+* counted in it; the next window starts from the next trigger after it.
+* A missed deadline (realtime_runner calls missed_deadline) records the
+* event and writes the pending window at once, as the run stops there.
+*
+* On the host the ring is allocated once by configure(), and the window is
+* written as text through a logger (replayed_window). On target the ring
+* and the last window live in SDRAM, above the LCD frame buffers, and
+* sdram_window leaves the window there for the debugger:
+*
+*   dump binary memory window.bin <DISCO_RECORDER_WINDOW> <+window_bytes>
+*   TRACE_DECODER window.bin
+*
+* Texts longer than a record holds are cut; text_size keeps their size.
+*/
+
+#ifndef DISCO_FLIGHT_RECORDER_HPP
+#define DISCO_FLIGHT_RECORDER_HPP
+
+#include <algorithm>
+#include <cadmium.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../engine/time_conversion.hpp"
+
+enum class flight_event : uint8_t { global_time, messages, state, missed_deadline };
+
+struct flight_record {
+    int64_t time;           // nanoseconds, see time_conversion
+    uint8_t event;          // flight_event
+    uint8_t time_fields;    // fields the time printed with
+    uint16_t text_size;     // size of the text logged, more than text holds if it was cut
+    char model[28];         // NUL terminated, cut to fit
+    char text[472];         // NUL terminated, cut to fit
+};
+static_assert(sizeof(flight_record) == 512, "flight records must stay 512 bytes");
+
+//Precedes a window's records, in SDRAM and in dumps of it
+struct flight_window {
+    char magic[4];          // "DFRW", written last
+    uint32_t record_size;   // sizeof(flight_record)
+    uint32_t window;        // windows written so far, this one included
+    uint32_t records;       // records following the header
+    uint32_t trigger;       // index of the triggering record among them
+    uint32_t triggers;      // triggers that fired within the window
+    char reason[40];        // NUL terminated
+};
+static_assert(sizeof(flight_window) == 64, "the window header must stay 64 bytes");
+
+const char flight_window_magic[4] = {'D', 'F', 'R', 'W'};
+
+#ifdef RT_ARM_MBED
+//Records before (trigger included) and after the trigger; ring and window (with its header) each fit in 2 MB of SDRAM
+#ifndef DISCO_RECORDER_BEFORE
+#define DISCO_RECORDER_BEFORE 3072
+#endif
+#ifndef DISCO_RECORDER_AFTER
+#define DISCO_RECORDER_AFTER 1023
+#endif
+//SDRAM from 0xD0400000: LCD_DISCO_F429ZI's frame buffers end at 0xD02AB000
+#ifndef DISCO_RECORDER_RING
+#define DISCO_RECORDER_RING 0xD0400000
+#endif
+#ifndef DISCO_RECORDER_WINDOW
+#define DISCO_RECORDER_WINDOW 0xD0600000
+#endif
+static_assert((DISCO_RECORDER_BEFORE + DISCO_RECORDER_AFTER) * sizeof(flight_record) + sizeof(flight_window) <= 0x200000,
+              "the flight recorder ring and window must each fit in 2 MB");
+#endif
+
+//Replays a record through LOGGER as the engine logged it
+template<typename TIME, typename LOGGER>
+void replay_flight_record(const flight_record& r) {
+    const TIME t = time_conversion<TIME>::from_nanoseconds(r.time, r.time_fields);
+    switch ((flight_event) r.event) {
+        case flight_event::global_time:
+            LOGGER::template log<cadmium::logger::logger_global_time, cadmium::logger::run_global_time>(t);
+            break;
+        case flight_event::messages:
+            LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, std::string(r.model), std::string(r.text));
+            break;
+        case flight_event::state:
+            LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(t, std::string(r.model), std::string(r.text));
+            break;
+        case flight_event::missed_deadline:
+            break; //shown by the window header
+    }
+}
+
+#ifndef RT_ARM_MBED
+//Writes each window to SINK_PROVIDER's sink, its events as LOGGER formats them
+template<typename TIME, typename LOGGER, typename SINK_PROVIDER>
+struct replayed_window {
+    static void begin(const flight_window& w, const flight_record& trigger) {
+        SINK_PROVIDER::sink() << "Flight recorder window " << w.window << ": " << w.reason << " at "
+                              << time_conversion<TIME>::from_nanoseconds(trigger.time, trigger.time_fields)
+                              << " (event " << w.trigger + 1 << " of " << w.records << ", "
+                              << w.triggers << " trigger" << (w.triggers == 1 ? "" : "s") << ")" << std::endl;
+    }
+
+    static void record(const flight_record& r) {
+        if ((flight_event) r.event == flight_event::missed_deadline) {
+            SINK_PROVIDER::sink() << r.text << std::endl;
+        } else {
+            replay_flight_record<TIME, LOGGER>(r);
+        }
+    }
+
+    static void end(const flight_window& w) {
+        SINK_PROVIDER::sink() << "End of flight recorder window " << w.window << std::endl;
+    }
+};
+#else
+//Copies the window to SDRAM at DISCO_RECORDER_WINDOW; each window replaces the last
+struct sdram_window {
+    static flight_window* header() {
+        return reinterpret_cast<flight_window*>(DISCO_RECORDER_WINDOW);
+    }
+
+    static void begin(const flight_window& w, const flight_record&) {
+        *header() = w;
+        memset(header()->magic, 0, sizeof(header()->magic)); //not a window until end()
+        _next = reinterpret_cast<flight_record*>(header() + 1);
+    }
+
+    static void record(const flight_record& r) {
+        *_next++ = r;
+    }
+
+    static void end(const flight_window&) {
+        memcpy(header()->magic, flight_window_magic, sizeof(flight_window_magic));
+    }
+
+private:
+    inline static flight_record* _next = nullptr;
+};
+#endif
+
+template<typename TIME, typename TRIGGER, typename WINDOW>
+class flight_recorder {
+    using conversion=time_conversion<TIME>;
+
+    inline static flight_record* _ring = nullptr;
+    #ifndef RT_ARM_MBED
+    inline static std::unique_ptr<flight_record[]> _storage;
+    inline static size_t _before = 0;
+    inline static size_t _after = 0;
+    #else
+    static constexpr size_t _before = DISCO_RECORDER_BEFORE;
+    static constexpr size_t _after = DISCO_RECORDER_AFTER;
+    #endif
+
+    inline static uint64_t _recorded = 0;
+    inline static bool _pending = false;
+    inline static uint64_t _trigger = 0;    // index of the pending window's trigger
+    inline static uint32_t _triggers = 0;   // triggers in the pending window
+    inline static const char* _reason = nullptr;
+    inline static uint32_t _windows = 0;
+    inline static const std::string _none; //model and text of global time events
+
+    static void copy_text(char* to, size_t size, const char* from, size_t length) {
+        const size_t n = std::min(length, size - 1);
+        memcpy(to, from, n);
+        to[n] = '\0';
+    }
+
+    static void store(flight_event event, const TIME& t, const std::string& model, const std::string& text) {
+        if (!_ring) {
+            #ifdef RT_ARM_MBED
+            //SDRAM is brought up with the LCD, so only touched once the run starts
+            _ring = reinterpret_cast<flight_record*>(DISCO_RECORDER_RING);
+            #else
+            configure(3072, 1023);
+            #endif
+        }
+        flight_record& r = _ring[_recorded % (_before + _after)];
+        r.time = conversion::count_nanoseconds(t);
+        r.time_fields = r.time % 1000000 ? 6 : 4; //enough fields to rebuild the time exactly
+        r.event = (uint8_t) event;
+        r.text_size = (uint16_t) std::min(text.size(), (size_t) UINT16_MAX);
+        copy_text(r.model, sizeof(r.model), model.data(), model.size());
+        copy_text(r.text, sizeof(r.text), text.data(), text.size());
+        _recorded++;
+    }
+
+    static void record(flight_event event, const TIME& t, const std::string& model, const std::string& text) {
+        store(event, t, model, text);
+        if (const char* reason = TRIGGER::fires(event, model, text)) {
+            trigger(reason);
+        }
+        if (_pending && _recorded == _trigger + 1 + _after) {
+            write_window();
+        }
+    }
+
+    static void trigger(const char* reason) {
+        if (!_pending) {
+            _pending = true;
+            _trigger = _recorded - 1;
+            _triggers = 0;
+            _reason = reason;
+        }
+        _triggers++;
+    }
+
+    static void write_window() {
+        const uint64_t first = _trigger + 1 > _before ? _trigger + 1 - _before : 0;
+        _windows++;
+
+        flight_window w;
+        memcpy(w.magic, flight_window_magic, sizeof(w.magic));
+        w.record_size = sizeof(flight_record);
+        w.window = _windows;
+        w.records = (uint32_t) (_recorded - first);
+        w.trigger = (uint32_t) (_trigger - first);
+        w.triggers = _triggers;
+        copy_text(w.reason, sizeof(w.reason), _reason, strlen(_reason));
+
+        const size_t capacity = _before + _after;
+        WINDOW::begin(w, _ring[_trigger % capacity]);
+        for (uint64_t i = first; i < _recorded; i++) {
+            WINDOW::record(_ring[i % capacity]);
+        }
+        WINDOW::end(w);
+        _pending = false;
+    }
+
+public:
+    //Host only: the window sizes, in events; allocates the ring (before + after records)
+    #ifndef RT_ARM_MBED
+    static void configure(size_t before, size_t after) {
+        _before = std::max(before, (size_t) 1);
+        _after = after;
+        _storage.reset(new flight_record[_before + _after]);
+        _ring = _storage.get();
+        _recorded = 0;
+        _pending = false;
+    }
+    #endif
+
+    template<typename DECLARED_SOURCE, typename EVENT, typename... PARAMs>
+    static void log(const PARAMs&... params) {
+        using namespace cadmium::logger;
+        if constexpr (std::is_same<DECLARED_SOURCE, logger_global_time>::value && std::is_same<EVENT, run_global_time>::value) {
+            record(flight_event::global_time, params..., _none, _none);
+        } else if constexpr (std::is_same<DECLARED_SOURCE, logger_messages>::value && std::is_same<EVENT, sim_messages_collect>::value) {
+            record(flight_event::messages, params...);
+        } else if constexpr (std::is_same<DECLARED_SOURCE, logger_state>::value && std::is_same<EVENT, sim_state>::value) {
+            record(flight_event::state, params...);
+        }
+    }
+
+    //Called by realtime_runner before a missed deadline stops the run
+    static void missed_deadline(const TIME& t, long long lateness_us) {
+        const std::string text = "MISSED SCHEDULED TIME ADVANCE DEADLINE (late by " + std::to_string(lateness_us) + " us)";
+        store(flight_event::missed_deadline, t, std::string(), text);
+        trigger("missed deadline");
+        write_window();
+    }
+
+    //Writes a window still waiting for its `after` events (e.g. at the end of the run)
+    static void finish() {
+        if (_pending) write_window();
+    }
+
+    static uint64_t recorded() { return _recorded; }
+    static uint32_t windows() { return _windows; }
+};
+
+//Tells when a condition starts to hold for a model's messages or states, so a lasting condition fires once
+class condition_edges {
+    std::vector<std::string> _holding; //event kind + model id, for each one it holds for
+
+public:
+    bool starts(flight_event event, const std::string& model, bool holds) {
+        const std::string key = (char) ('0' + (int) event) + model;
+        const auto holding = std::find(_holding.begin(), _holding.end(), key);
+        if (!holds) {
+            if (holding != _holding.end()) _holding.erase(holding);
+            return false;
+        }
+        if (holding != _holding.end()) return false;
+        _holding.push_back(key);
+        return true;
+    }
+};
+
+//Fires when a model's messages or states start to contain text (empty fires on none)
+struct text_trigger {
+    inline static std::string text;
+    inline static condition_edges edges;
+
+    static const char* fires(flight_event event, const std::string& model, const std::string& event_text) {
+        if (text.empty() || event == flight_event::global_time) return nullptr;
+        return edges.starts(event, model, event_text.find(text) != std::string::npos) ? "text trigger" : nullptr;
+    }
+};
+
+#endif // DISCO_FLIGHT_RECORDER_HPP
@@ -0,0 +1,150 @@
+/**
+* ARSLab - Carleton University
+*
+* Trace decoder:
+* Turns a binary trace written by binary_logger back into the text log
+* the formatter logger would have written. Records are replayed through
+* cadmium's own formatter, so the output matches it byte for byte.
+* It also reads a flight recorder window dumped from the board's SDRAM
+* (loggers/flight_recorder.hpp).
+*
+* Usage: TRACE_DECODER trace.bin|window.bin [output.txt]
+*/
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <cadmium.h>
+#include <NDTime.hpp>
+
+#include "../loggers/binary_logger.hpp"
+#include "../loggers/flight_recorder.hpp"
+
+using namespace std;
+using TIME = NDTime;
+
+static std::ostream* out = &cout;
+
+struct decoder_sink_provider{
+    static std::ostream& sink(){
+        return *out;
+    }
+};
+
+//Replay one record through the text logger of its event
+template<size_t I = 0>
+bool replay(uint8_t event, const TIME& t, const std::string& model_id, const std::string& text) {
+    if constexpr (I == std::tuple_size<disco_trace::traced_events>::value) {
+        return false;
+    } else {
+        using entry=typename std::tuple_element<I, disco_trace::traced_events>::type;
+        using text_logger=cadmium::logger::logger<typename entry::source, cadmium::dynamic::logger::formatter<TIME>, decoder_sink_provider>;
+
+        if (event != I) {
+            return replay<I + 1>(event, t, model_id, text);
+        }
+        if constexpr (entry::shape == disco_trace::event_shape::time) {
+            text_logger::template log<typename entry::source, typename entry::event>(t);
+        } else {
+            text_logger::template log<typename entry::source, typename entry::event>(t, model_id, text);
+        }
+        return true;
+    }
+}
+
+using text_events=cadmium::logger::multilogger<
+    cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<TIME>, decoder_sink_provider>,
+    cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, decoder_sink_provider>,
+    cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<TIME>, decoder_sink_provider>
+>;
+using decoded_window=replayed_window<TIME, text_events, decoder_sink_provider>;
+
+//The rest of a flight recorder window, after its magic
+int decode_window(istream& in, const char* file) {
+    flight_window window;
+    memcpy(window.magic, flight_window_magic, sizeof(window.magic));
+    in.read(reinterpret_cast<char*>(&window) + sizeof(window.magic), sizeof(window) - sizeof(window.magic));
+    if (!in || window.record_size != sizeof(flight_record) || window.trigger >= window.records) {
+        cerr << file << " is not a flight recorder window of " << sizeof(flight_record) << " byte records" << endl;
+        return 1;
+    }
+    window.reason[sizeof(window.reason) - 1] = '\0';
+
+    vector<flight_record> records(window.records);
+    if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(flight_record))) {
+        cerr << "Truncated window" << endl;
+        return 1;
+    }
+    decoded_window::begin(window, records[window.trigger]);
+    for (flight_record& r : records) {
+        r.model[sizeof(r.model) - 1] = '\0';
+        r.text[sizeof(r.text) - 1] = '\0';
+        decoded_window::record(r);
+    }
+    decoded_window::end(window);
+    return 0;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " trace.bin|window.bin [output.txt]" << endl;
+        return 1;
+    }
+
+    ifstream in(argv[1], ios::binary);
+    if (!in) {
+        cerr << "Cannot open " << argv[1] << endl;
+        return 1;
+    }
+
+    ofstream out_file;
+    if (argc > 2) {
+        out_file.open(argv[2]);
+        out = &out_file;
+    }
+
+    char magic[sizeof(disco_trace::magic)];
+    uint32_t version;
+    in.read(magic, sizeof(magic));
+    if (in && equal(magic, magic + sizeof(magic), flight_window_magic)) {
+        return decode_window(in, argv[1]);
+    }
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!in || !equal(magic, magic + sizeof(magic), disco_trace::magic) || version != disco_trace::version) {
+        cerr << argv[1] << " is not a version " << disco_trace::version << " DISCO trace" << endl;
+        return 1;
+    }
+
+    vector<string> models(1);
+    disco_trace::record_header header;
+    string payload;
+
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        payload.resize(header.payload_size);
+        if (header.payload_size && !in.read(&payload[0], header.payload_size)) {
+            cerr << "Truncated record" << endl;
+            return 1;
+        }
+
+        if (header.event == disco_trace::dictionary_event) {
+            if (models.size() <= header.model) models.resize(header.model + 1);
+            models[header.model] = payload;
+            continue;
+        }
+
+        if (header.model >= models.size()) {
+            cerr << "Record refers to undeclared model " << header.model << endl;
+            return 1;
+        }
+
+        const TIME t = time_conversion<TIME>::from_nanoseconds(header.time, header.time_fields);
+        if (!replay(header.event, t, models[header.model], payload)) {
+            cerr << "Unknown event " << (int) header.event << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+/**
+* ARSLab - Carleton University
+*
+* Batch runner options:
+* Command line handling and the end-of-run throughput report for the
+* simulator build of DISCO_TOP.
+*/
+
+#ifndef DISCO_BATCH_OPTIONS_HPP
+#define DISCO_BATCH_OPTIONS_HPP
+
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+
+enum class logger_selection { none, top, all, binary, trace, delta, recorder };
+
+struct batch_options {
+    std::string horizon = "00:01:00:000";
+    std::string inputs = "./inputs";
+    std::string outputs = "./outputs";
+    std::string log_file;
+    logger_selection logger = logger_selection::top;
+    std::string keyframe = "00:10:00:000"; //delta logger keyframe period
+
+    //Flight recorder: events kept before (trigger included) and after a trigger, and text that also triggers
+    size_t before = 3072;
+    size_t after = 1023;
+    std::string trigger;
+    bool async = false;
+    bool help = false;
+
+    //Monte Carlo sweep: sweep_runs copies of TOP seeded seed, seed+1, ...
+    size_t sweep_runs = 0;
+    unsigned int seed = 1;
+    unsigned int threads = 0;
+
+    //Time-parallel run: the horizon cut into this many segments run side by side (0: sequential)
+    size_t segments = 0;
+
+    //Fleet mode: TOP built with this many sensor chains (0: the board's TOP)
+    size_t chains = 0;
+    bool cross_links = false;
+    size_t spares = 0;
+
+    //Checkpoints: save the run at checkpoint_at to checkpoint, or resume from resume
+    std::string checkpoint_at;
+    std::string checkpoint = "disco_checkpoint.bin";
+    std::string resume;
+
+    //Real-time mode: pace TOP to the wall clock, speedup times faster than real time
+    bool realtime = false;
+    double speedup = 1.0;
+
+    //Run on flat_runner (couplings resolved once) instead of cadmium's coordinators
+    bool flat = false;
+
+    //flat_runner with the atomics of each simulated time run on this many threads (0: serially)
+    unsigned int parallel = 0;
+
+    //flat_runner jumping over the polls of sensors no one listens to, and checking each jump against stepping
+    bool skip_idle = false;
+    bool verify_skip = false;
+
+    //Build switch1 -> arbiter1 as the single atomic switch_arbiter1
+    bool fuse = false;
+
+    //Trace Event Format file of every transition, output and message (empty: none)
+    std::string chrome_trace;
+};
+
+inline void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  -t, --until HH:MM:SS:mmm   simulated horizon (default 00:01:00:000)\n"
+              << "  -i, --inputs DIR           directory holding TS_in.txt (default ./inputs)\n"
+              << "  -o, --outputs DIR          directory for LCD_out.txt (default ./outputs)\n"
+              << "  -l, --log FILE             simulation log file (default disco_output.txt, .bin for binary)\n"
+              << "  -L, --logger LOGGER        what to log (default top: messages and global time)\n"
+              << "                             none, top, all, binary (top as a binary trace), or trace\n"
+              << "                             (top for the switch and arbiter outputs only), or delta\n"
+              << "                             (top plus model states, written only when they change)\n"
+              << "                             or recorder (every event kept in memory, written only around\n"
+              << "                             a trigger: the LCD turning grey, a missed deadline, --trigger)\n"
+              << "      --keyframe T           delta: rewrite every model's state every T (default 00:10:00:000)\n"
+              << "      --before N             recorder: events written up to the trigger (default 3072)\n"
+              << "      --after N              recorder: events written after the trigger (default 1023)\n"
+              << "      --trigger TEXT         recorder: also trigger on any event whose text contains TEXT\n"
+              << "  -a, --async                write the log from a background thread\n"
+              << "  -s, --sweep N              run N independently seeded copies of TOP in parallel\n"
+              << "                             (no logging) and report merged statistics\n"
+              << "      --seed S               seed of the first sweep run (default 1)\n"
+              << "  -j, --threads T            sweep and segment threads (default one per core)\n"
+              << "      --segments S           cut the horizon into S segments run side by side from\n"
+              << "                             predicted states (re-run where the prediction was wrong;\n"
+              << "                             same log and LCD output as a sequential run)\n"
+              << "  -k, --chains K             simulate a fleet of K sensor/switch/arbiter/LCD chains\n"
+              << "                             (LCD output to <outputs>/LCD_out_<k>.txt)\n"
+              << "      --cross-links          fleet: each analog sensor also feeds the next chain's switch\n"
+              << "      --spares N             fleet: N unwired digital sensors per chain\n"
+              << "      --checkpoint-at T      save the whole simulation state at simulated time T\n"
+              << "      --checkpoint FILE      where to save it (default disco_checkpoint.bin)\n"
+              << "      --resume FILE          continue a run from a saved checkpoint\n"
+              << "  -r, --realtime             pace the run to the wall clock, as on the board\n"
+              << "  -x, --speedup FACTOR       real-time speed-up (default 1: real time)\n"
+              << "  -f, --flat                 route messages through a precomputed flat coupling table\n"
+              << "  -p, --parallel T           flat, with the atomics due at the same time run on T threads\n"
+              << "      --skip-idle            flat, jumping over the polls of sensors whose readings reach no\n"
+              << "                             model and are not logged, instead of stepping through them\n"
+              << "      --verify-skip          skip-idle, checking every jump against stepping through the polls\n"
+              << "      --fuse                 run switch1 and arbiter1 as one atomic (one engine round\n"
+              << "                             less per sample, same LCD output)\n"
+              << "      --chrome-trace FILE    write every transition, output and message to FILE in\n"
+              << "                             Trace Event Format, on wall-clock and simulated-time\n"
+              << "                             tracks (open in ui.perfetto.dev or chrome://tracing)\n"
+              << "  -h, --help                 show this message\n";
+}
+
+//A count written as the whole value: std::invalid_argument if it is not one, std::out_of_range if too large for T
+template<typename T>
+T parse_count(const std::string& value) {
+    size_t used = 0;
+    if (value.empty() || value[0] == '-') throw std::invalid_argument(value);
+    const unsigned long long n = std::stoull(value, &used);
+    if (used != value.size()) throw std::invalid_argument(value);
+    if (n > std::numeric_limits<T>::max()) throw std::out_of_range(value);
+    return (T) n;
+}
+
+inline double parse_number(const std::string& value) {
+    size_t used = 0;
+    const double x = std::stod(value, &used);
+    if (used != value.size()) throw std::invalid_argument(value);
+    return x;
+}
+
+//Returns false (after reporting on cerr) if the command line is invalid
+inline bool parse_batch_options(int argc, char ** argv, batch_options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+
+        auto is = [arg](const char* short_name, const char* long_name) {
+            return strcmp(arg, short_name) == 0 || strcmp(arg, long_name) == 0;
+        };
+
+        if (is("-h", "--help")) {
+            options.help = true;
+            continue;
+        }
+        if (is("-a", "--async")) {
+            options.async = true;
+            continue;
+        }
+        if (is("--cross-links", "--cross-links")) {
+            options.cross_links = true;
+            continue;
+        }
+        if (is("-r", "--realtime")) {
+            options.realtime = true;
+            continue;
+        }
+        if (is("-f", "--flat")) {
+            options.flat = true;
+            continue;
+        }
+        if (is("--fuse", "--fuse")) {
+            options.fuse = true;
+            continue;
+        }
+        if (is("--skip-idle", "--skip-idle")) {
+            options.skip_idle = true;
+            options.flat = true;
+            continue;
+        }
+        if (is("--verify-skip", "--verify-skip")) {
+            options.skip_idle = true;
+            options.verify_skip = true;
+            options.flat = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "Unknown option or missing value: " << arg << "\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        const std::string value = argv[++i];
+
+        try {
+            if (is("-t", "--until")) {
+                options.horizon = value;
+            } else if (is("-i", "--inputs")) {
+                options.inputs = value;
+            } else if (is("-o", "--outputs")) {
+                options.outputs = value;
+            } else if (is("-s", "--sweep")) {
+                options.sweep_runs = parse_count<size_t>(value);
+            } else if (is("--seed", "--seed")) {
+                options.seed = parse_count<unsigned int>(value);
+            } else if (is("-j", "--threads")) {
+                options.threads = parse_count<unsigned int>(value);
+            } else if (is("--segments", "--segments")) {
+                options.segments = parse_count<size_t>(value);
+            } else if (is("--checkpoint-at", "--checkpoint-at")) {
+                options.checkpoint_at = value;
+            } else if (is("--checkpoint", "--checkpoint")) {
+                options.checkpoint = value;
+            } else if (is("--resume", "--resume")) {
+                options.resume = value;
+            } else if (is("--keyframe", "--keyframe")) {
+                options.keyframe = value;
+            } else if (is("--before", "--before")) {
+                options.before = parse_count<size_t>(value);
+            } else if (is("--after", "--after")) {
+                options.after = parse_count<size_t>(value);
+            } else if (is("--trigger", "--trigger")) {
+                options.trigger = value;
+            } else if (is("--chrome-trace", "--chrome-trace")) {
+                options.chrome_trace = value;
+            } else if (is("-p", "--parallel")) {
+                options.parallel = parse_count<unsigned int>(value);
+                options.flat = true;
+            } else if (is("-k", "--chains")) {
+                options.chains = parse_count<size_t>(value);
+            } else if (is("--spares", "--spares")) {
+                options.spares = parse_count<size_t>(value);
+            } else if (is("-x", "--speedup")) {
+                options.speedup = parse_number(value);
+                options.realtime = true;
+                if (!std::isfinite(options.speedup) || options.speedup <= 0) {
+                    std::cerr << "The speed-up must be a positive number\n";
+                    return false;
+                }
+            } else if (is("-l", "--log")) {
+                options.log_file = value;
+            } else if (is("-L", "--logger")) {
+                if (value == "none") {
+                    options.logger = logger_selection::none;
+                } else if (value == "top") {
+                    options.logger = logger_selection::top;
+                } else if (value == "all") {
+                    options.logger = logger_selection::all;
+                } else if (value == "binary") {
+                    options.logger = logger_selection::binary;
+                } else if (value == "trace") {
+                    options.logger = logger_selection::trace;
+                } else if (value == "delta") {
+                    options.logger = logger_selection::delta;
+                } else if (value == "recorder") {
+                    options.logger = logger_selection::recorder;
+                } else {
+                    std::cerr << "Unknown logger: " << value << "\n";
+                    return false;
+                }
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                print_usage(argv[0]);
+                return false;
+            }
+        } catch (const std::logic_error&) {
+            //std::invalid_argument or std::out_of_range from a numeric value
+            std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.log_file.empty()) {
+        options.log_file = (options.logger == logger_selection::binary) ? "disco_output.bin" : "disco_output.txt";
+    }
+    return true;
+}
+
+template<typename TIME>
+void print_throughput_report(std::ostream& os, const TIME& simulated, double wall_seconds, unsigned long long transitions) {
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+
+    os << "Simulated time: " << simulated << "\n"
+       << "Wall time:      " << std::fixed << std::setprecision(3) << wall_seconds << " s\n"
+       << "Transitions:    " << transitions << "\n"
+       << "Events/sec:     " << std::setprecision(0) << (wall_seconds > 0 ? transitions / wall_seconds : 0.0) << "\n";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+#endif // DISCO_BATCH_OPTIONS_HPP
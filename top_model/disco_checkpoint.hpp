@@ -0,0 +1,163 @@
+/**
+* ARSLab - Carleton University
+*
+* DISCO checkpoints:
+* checkpoint_state for the DISCO atomics whose state_type cannot be copied
+* byte for byte, or whose copy holds uninitialized bytes (padding, text past
+* its terminator): equal states must give equal snapshots. Include this header rather than
+* engine/checkpoint.hpp so the specializations are seen first.
+*/
+
+#ifndef DISCO_CHECKPOINT_STATES_HPP
+#define DISCO_CHECKPOINT_STATES_HPP
+
+#ifndef RT_ARM_MBED
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <sstream>
+
+#include "disco_top.hpp"
+#include "../engine/checkpoint.hpp"
+
+//Readings and the generator that draws them
+template<>
+struct checkpoint_state<DigitalTemperatureHumidity> {
+    template<typename TIME>
+    static void save(const DigitalTemperatureHumidity<TIME>& model, const model_history<TIME>&, checkpoint_writer& out) {
+        out.pod(model.state);
+        std::ostringstream random_state;
+        model.save_random_state(random_state);
+        out.text(random_state.str());
+    }
+
+    template<typename TIME>
+    static void restore(DigitalTemperatureHumidity<TIME>& model, const model_history<TIME>&, checkpoint_reader& in) {
+        in.pod(model.state);
+        std::istringstream random_state(in.text());
+        model.load_random_state(random_state);
+    }
+};
+
+//The latest sample of each sensor, field by field
+template<>
+struct checkpoint_state<Switch> {
+    template<typename TIME>
+    static void save(const Switch<TIME>& model, const model_history<TIME>&, checkpoint_writer& out) {
+        out.pod(model.state.propagating);
+        out.pod(model.state.sensor_idx);
+        for (const sensor_data& sensor : model.state.sensor_update) {
+            out.text(std::string(sensor.sensor_name, strnlen(sensor.sensor_name, sizeof(sensor.sensor_name))));
+            out.pod(sensor.temperature);
+            out.pod(sensor.humidity);
+        }
+    }
+
+    template<typename TIME>
+    static void restore(Switch<TIME>& model, const model_history<TIME>&, checkpoint_reader& in) {
+        in.pod(model.state.propagating);
+        in.pod(model.state.sensor_idx);
+        for (sensor_data& sensor : model.state.sensor_update) {
+            const std::string name = in.text();
+            memset(sensor.sensor_name, 0, sizeof(sensor.sensor_name));
+            memcpy(sensor.sensor_name, name.data(), std::min(name.size(), sizeof(sensor.sensor_name) - 1));
+            in.pod(sensor.temperature);
+            in.pod(sensor.humidity);
+        }
+    }
+};
+
+//The update being shown; its lines are shared with the updates sent
+template<>
+struct checkpoint_state<Arbiter> {
+    //Equal lines give equal bytes: what follows the text's terminator is left uninitialized by the arbiter
+    static lcd_update_line canonical(const lcd_update_line& line) {
+        lcd_update_line copy;
+        memset(&copy, 0, sizeof(copy));
+        copy.line_index = line.line_index;
+        memcpy(copy.characters, line.characters, strnlen(line.characters, sizeof(line.characters)));
+        copy.alignment = line.alignment;
+        return copy;
+    }
+
+    template<typename TIME>
+    static void save(const Arbiter<TIME>& model, const model_history<TIME>&, checkpoint_writer& out) {
+        out.pod(model.state.propagating);
+        out.pod(model.state.output.lcd_colour);
+        out.pod(model.state.output.text_colour);
+        const std::list<lcd_update_line> none;
+        const std::list<lcd_update_line>& lines = model.state.output.lines ? *model.state.output.lines : none;
+        out.pod((uint32_t) lines.size());
+        for (const lcd_update_line& line : lines) {
+            out.pod(canonical(line));
+        }
+    }
+
+    template<typename TIME>
+    static void restore(Arbiter<TIME>& model, const model_history<TIME>&, checkpoint_reader& in) {
+        uint32_t lines = 0;
+        in.pod(model.state.propagating);
+        in.pod(model.state.output.lcd_colour);
+        in.pod(model.state.output.text_colour);
+        in.pod(lines);
+        std::list<lcd_update_line> restored;
+        for (uint32_t i = 0; i < lines; i++) {
+            lcd_update_line line;
+            in.pod(line);
+            restored.push_back(line);
+        }
+        model.state.output.lines = std::make_shared<const std::list<lcd_update_line>>(std::move(restored));
+    }
+};
+
+//Both halves of the fused pair, and how long each has been idle
+template<>
+struct checkpoint_state<SwitchArbiter> {
+    template<typename TIME>
+    static void save(const SwitchArbiter<TIME>& model, const model_history<TIME>& history, checkpoint_writer& out) {
+        checkpoint_state<Switch>::save(model.state.first, history, out);
+        checkpoint_state<Arbiter>::save(model.state.second, history, out);
+        out.time(model.state.first_elapsed);
+        out.time(model.state.second_elapsed);
+    }
+
+    template<typename TIME>
+    static void restore(SwitchArbiter<TIME>& model, const model_history<TIME>& history, checkpoint_reader& in) {
+        checkpoint_state<Switch>::restore(model.state.first, history, in);
+        checkpoint_state<Arbiter>::restore(model.state.second, history, in);
+        model.state.first_elapsed = in.time<TIME>();
+        model.state.second_elapsed = in.time<TIME>();
+    }
+};
+
+//File inputs: the offset into the input is the number of records read, replayed on restore
+template<> struct checkpoint_state<TouchScreen> : replay_internal_transitions<TouchScreen> {};
+template<> struct checkpoint_state<AnalogInput> : replay_internal_transitions<AnalogInput> {};
+
+//File output: bring a fresh LCD's clock to its last transition; earlier updates stay in the saved run's file
+template<>
+struct checkpoint_state<LCD> {
+    template<typename TIME>
+    static void save(const LCD<TIME>&, const model_history<TIME>&, checkpoint_writer&) {}
+
+    template<typename TIME>
+    static void restore(LCD<TIME>& model, const model_history<TIME>& history, checkpoint_reader&) {
+        model.external_transition(history.last, typename make_message_bags<typename LCD<TIME>::input_ports>::type());
+    }
+};
+
+//Tallies belong to the run that owns the monitor_stats
+template<>
+struct checkpoint_state<DisplayMonitor> {
+    template<typename TIME>
+    static void save(const DisplayMonitor<TIME>&, const model_history<TIME>&, checkpoint_writer&) {}
+
+    template<typename TIME>
+    static void restore(DisplayMonitor<TIME>&, const model_history<TIME>&, checkpoint_reader&) {}
+};
+
+#endif // RT_ARM_MBED
+
+#endif // DISCO_CHECKPOINT_STATES_HPP
@@ -0,0 +1,40 @@
+/**
+* ARSLab - Carleton University
+*
+* DISCO quiescent pollers:
+* quiet_polls for the DISCO atomics whose polls can be skipped while no
+* one listens (engine/quiescence.hpp). The simulated digital sensor draws
+* a reading every period and does nothing else, and is stepped through
+* the skipped polls. Built with -DDISCO_FIXED_DRAWS each poll takes the
+* same number of draws, so its generator jumps over all the skipped polls
+* but the last, which is drawn; the readings then differ from the default
+* build's. The touch screen and the analog input read their files and are
+* stepped as usual.
+*/
+
+#ifndef DISCO_QUIESCENCE_POLLS_HPP
+#define DISCO_QUIESCENCE_POLLS_HPP
+
+#ifndef RT_ARM_MBED
+
+#include "disco_top.hpp"
+#include "../engine/quiescence.hpp"
+
+#ifdef DISCO_FIXED_DRAWS
+template<> struct quiet_polls<DigitalTemperatureHumidity> {
+    static constexpr bool declared = true;
+
+    template<typename TIME>
+    static void skip(DigitalTemperatureHumidity<TIME>& model, unsigned long long n) {
+        if (n == 0) return;
+        model.discard_polls(n - 1);
+        model.internal_transition();
+    }
+};
+#else
+template<> struct quiet_polls<DigitalTemperatureHumidity> : periodic_polls<DigitalTemperatureHumidity> {};
+#endif
+
+#endif // RT_ARM_MBED
+
+#endif // DISCO_QUIESCENCE_POLLS_HPP
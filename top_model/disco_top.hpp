@@ -0,0 +1,173 @@
+/**
+* ARSLab - Carleton University
+*
+* DISCO TOP model:
+* Sensors -> Switch -> Arbiter -> LCD, with the touch screen selecting
+* which sensor is shown. Shared by the main program and the benchmarks.
+*/
+
+#ifndef DISCO_TOP_HPP
+#define DISCO_TOP_HPP
+
+#include <cadmium.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "../atomics/lcd.hpp"
+#include "../atomics/digital_temp_humidity.hpp"
+#include "../atomics/arbiter.hpp"
+#include "../atomics/touch_screen.hpp"
+#include "../atomics/switch.hpp"
+#include "../atomics/display_monitor.hpp"
+#include "../data_structures/time_literals.hpp"
+#include "../engine/model_scope.hpp"
+#include "../engine/fused_model.hpp"
+
+#include <cadmium/real_time/arm_mbed/io/analogInput.hpp>
+
+#ifndef RT_ARM_MBED
+//Dummy pins for Temperature Sensors
+const char* PC_9;
+const char* PA_8;
+const char* PF_6;
+#endif
+
+//Builds every atomic exactly as written
+template<template<typename> class ATOMIC>
+struct undecorated {
+    template<typename TIME>
+    using model = ATOMIC<TIME>;
+};
+
+//Applies INNER, then OUTER: make_disco_top<TIME, stacked<lateness_tracked, counted>::decorator>
+template<template<template<typename> class> class OUTER, template<template<typename> class> class INNER>
+struct stacked {
+    template<template<typename> class ATOMIC>
+    struct decorator {
+        template<typename TIME>
+        using model = typename OUTER<INNER<ATOMIC>::template model>::template model<TIME>;
+    };
+};
+
+//make_dynamic_atomic_model, building the model inside a model_scope named id
+template<template<typename> class ATOMIC, typename TIME, typename... ARGS>
+std::shared_ptr<cadmium::dynamic::modeling::model> make_scoped_atomic(const char* id, ARGS&&... args) {
+    model_scope scope(id);
+    return cadmium::dynamic::translate::make_dynamic_atomic_model<ATOMIC, TIME>(id, std::forward<ARGS>(args)...);
+}
+
+//Switch and Arbiter as one atomic: each sample reaches the LCD one engine round sooner
+template<typename TIME>
+class SwitchArbiter : public fused<Switch, Arbiter, switch_defs::sensor_out, arbiter_defs::sensor_in>::template model<TIME> {};
+
+//Simulator options (ignored on the board, apart from fuse_switch_arbiter)
+struct disco_top_config {
+    //switch1 -> arbiter1 built as the single atomic switch_arbiter1
+    bool fuse_switch_arbiter = false;
+
+    #ifndef RT_ARM_MBED
+    std::string ts_input = TS_FILE;
+    std::string lcd_output = LCD_FILE;
+
+    //Seed for the simulated digital sensor (default engine seed otherwise)
+    bool seeded = false;
+    unsigned int seed = 0;
+
+    //Adds a DisplayMonitor tallying sensor samples and LCD updates here
+    monitor_stats* monitor = nullptr;
+    #endif
+};
+
+/*
+* DECORATE wraps every atomic before it is handed to the engine
+* (e.g. counted from engine/transition_counter.hpp). Every atomic is built
+* inside a model_scope carrying its id.
+*/
+template<typename TIME, template<template<typename> class> class DECORATE = undecorated>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> make_disco_top(const disco_top_config& config = disco_top_config()) {
+    using cadmium::dynamic::translate::make_IC;
+    using AtomicModelPtr=std::shared_ptr<cadmium::dynamic::modeling::model>;
+
+    /********************************************/
+    /******* Temperature Sensors *********/
+    /********************************************/
+    #ifdef RT_ARM_MBED
+    AtomicModelPtr digital_temp_humidity1 = make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>("digital_temp_humidity1", PC_9, PA_8);
+    #else
+    AtomicModelPtr digital_temp_humidity1 = config.seeded ?
+        make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>("digital_temp_humidity1", PC_9, PA_8, to_time<TIME>(1_s), config.seed) :
+        make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>("digital_temp_humidity1", PC_9, PA_8);
+    #endif
+    AtomicModelPtr analog_temp1 = make_scoped_atomic<DECORATE<AnalogInput>::template model, TIME>("analog_temp1", PF_6, to_time<TIME>(1_s));
+
+    /********************************************/
+    /********* LCD & Touch Screen ***************/
+    /********************************************/
+    #ifdef RT_ARM_MBED
+    AtomicModelPtr lcd1 = make_scoped_atomic<DECORATE<LCD>::template model, TIME>("lcd1");
+    AtomicModelPtr ts1 = make_scoped_atomic<DECORATE<TouchScreen>::template model, TIME>("ts1");
+    #else
+    AtomicModelPtr lcd1 = make_scoped_atomic<DECORATE<LCD>::template model, TIME>("lcd1", config.lcd_output.c_str());
+    AtomicModelPtr ts1 = make_scoped_atomic<DECORATE<TouchScreen>::template model, TIME>("ts1", config.ts_input.c_str());
+    #endif
+
+    /********************************************/
+    /********* Arbiter & Switch *****************/
+    /********************************************/
+    cadmium::dynamic::modeling::Ports iports_TOP = {};
+    cadmium::dynamic::modeling::Ports oports_TOP = {};
+    cadmium::dynamic::modeling::Models submodels_TOP =  {digital_temp_humidity1, analog_temp1, lcd1, ts1};
+    cadmium::dynamic::modeling::EICs eics_TOP = {};
+    cadmium::dynamic::modeling::EOCs eocs_TOP = {};
+    cadmium::dynamic::modeling::ICs ics_TOP = {};
+
+    //Sensor samples enter the switch (or the fused pair) and LCD updates leave the arbiter
+    std::string sensors_to = "switch1";
+    std::string lcd_from = "arbiter1";
+    if (config.fuse_switch_arbiter) {
+        #ifndef RT_ARM_MBED
+        if (config.monitor) throw std::logic_error("The display monitor needs switch1's output: do not fuse switch1 and arbiter1");
+        #endif
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<SwitchArbiter>::template model, TIME>("switch_arbiter1"));
+        sensors_to = "switch_arbiter1";
+        lcd_from = "switch_arbiter1";
+    } else {
+        AtomicModelPtr arbiter1 = make_scoped_atomic<DECORATE<Arbiter>::template model, TIME>("arbiter1");
+        AtomicModelPtr switch1 = make_scoped_atomic<DECORATE<Switch>::template model, TIME>("switch1");
+        submodels_TOP.insert(submodels_TOP.begin() + 2, arbiter1);
+        submodels_TOP.push_back(switch1);
+    }
+
+    /************************/
+    /*******TOP MODEL********/
+    /************************/
+    ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::temperature_out, switch_defs::temperature_in_1>("digital_temp_humidity1", sensors_to));
+    ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::humidity_out, switch_defs::humidity_in_1>("digital_temp_humidity1", sensors_to));
+    ics_TOP.push_back(make_IC<analogInput_defs::out, switch_defs::temperature_in_2>("analog_temp1", sensors_to));
+    ics_TOP.push_back(make_IC<TS_defs::out, switch_defs::ts_in>("ts1", sensors_to));
+    if (!config.fuse_switch_arbiter) {
+        ics_TOP.push_back(make_IC<switch_defs::sensor_out, arbiter_defs::sensor_in>("switch1", "arbiter1"));
+    }
+    ics_TOP.push_back(make_IC<arbiter_defs::lcd_update_out, LCD_defs::in>(lcd_from, "lcd1"));
+
+    #ifndef RT_ARM_MBED
+    if (config.monitor) {
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<DisplayMonitor>::template model, TIME>("monitor1", config.monitor));
+        ics_TOP.push_back(make_IC<switch_defs::sensor_out, displayMonitor_defs::sensor_in>("switch1", "monitor1"));
+        ics_TOP.push_back(make_IC<arbiter_defs::lcd_update_out, displayMonitor_defs::lcd_in>("arbiter1", "monitor1"));
+    }
+    #endif
+    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        "TOP",
+        submodels_TOP,
+        iports_TOP,
+        oports_TOP,
+        eics_TOP,
+        eocs_TOP,
+        ics_TOP
+    );
+}
+
+#endif // DISCO_TOP_HPP
@@ -0,0 +1,178 @@
+/**
+* ARSLab - Carleton University
+*
+* Fleet TOP model:
+* Simulator-only generator for installations with many sensor stations.
+* Builds K copies of the DISCO chain (digital and analog sensor -> Switch ->
+* Arbiter -> LCD), all switched by one shared touch screen. With
+* cross_links every analog sensor also feeds the next chain's switch.
+* Each chain can also have spare digital sensors: polled like the others,
+* but wired to nothing.
+*
+* make_fan_in_top builds the opposite shape: one chain whose switch takes
+* the readings of many analog sensors, optionally from inside a nested
+* coupled model.
+*/
+
+#ifndef DISCO_FLEET_TOP_HPP
+#define DISCO_FLEET_TOP_HPP
+
+#ifndef RT_ARM_MBED
+
+#include <memory>
+#include <string>
+
+#include "disco_top.hpp"
+
+struct fleet_config {
+    size_t chains = 1;
+    bool cross_links = false;
+
+    std::string ts_input = TS_FILE;
+    //Directory for LCD_out_<k>.txt, one file per chain (empty: discard LCD output)
+    std::string lcd_output_dir;
+
+    //Chain k's digital sensor is seeded seed + k
+    unsigned int seed = 1;
+
+    //Unwired digital sensors per chain; spare j of chain k is seeded seed + k + j * chains
+    size_t spare_sensors = 0;
+};
+
+/*
+* Model ids are <model><k> for k = 1..chains (digital_temp_humidity1,
+* switch1, ...) plus one ts1, and spare_sensor<k>_<j> for j = 1..spare_sensors.
+* DECORATE is applied as in make_disco_top.
+*/
+template<typename TIME, template<template<typename> class> class DECORATE = undecorated>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> make_fleet_top(const fleet_config& config) {
+    using cadmium::dynamic::translate::make_IC;
+
+    cadmium::dynamic::modeling::Models submodels_TOP;
+    cadmium::dynamic::modeling::ICs ics_TOP;
+
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<TouchScreen>::template model, TIME>("ts1", config.ts_input.c_str()));
+
+    for (size_t k = 1; k <= config.chains; k++) {
+        const std::string n = std::to_string(k);
+        const std::string digital = "digital_temp_humidity" + n;
+        const std::string analog = "analog_temp" + n;
+        const std::string sensor_switch = "switch" + n;
+        const std::string arbiter = "arbiter" + n;
+        const std::string lcd = "lcd" + n;
+        const std::string lcd_output = config.lcd_output_dir.empty() ? "/dev/null" : config.lcd_output_dir + "/LCD_out_" + n + ".txt";
+
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>(digital.c_str(),
+            PC_9, PA_8, to_time<TIME>(1_s), config.seed + (unsigned int) k));
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<AnalogInput>::template model, TIME>(analog.c_str(), PF_6, to_time<TIME>(1_s)));
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<Switch>::template model, TIME>(sensor_switch.c_str()));
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<Arbiter>::template model, TIME>(arbiter.c_str()));
+        submodels_TOP.push_back(make_scoped_atomic<DECORATE<LCD>::template model, TIME>(lcd.c_str(), lcd_output.c_str()));
+
+        ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::temperature_out, switch_defs::temperature_in_1>(digital, sensor_switch));
+        ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::humidity_out, switch_defs::humidity_in_1>(digital, sensor_switch));
+        ics_TOP.push_back(make_IC<analogInput_defs::out, switch_defs::temperature_in_2>(analog, sensor_switch));
+        ics_TOP.push_back(make_IC<TS_defs::out, switch_defs::ts_in>("ts1", sensor_switch));
+        ics_TOP.push_back(make_IC<switch_defs::sensor_out, arbiter_defs::sensor_in>(sensor_switch, arbiter));
+        ics_TOP.push_back(make_IC<arbiter_defs::lcd_update_out, LCD_defs::in>(arbiter, lcd));
+
+        for (size_t j = 1; j <= config.spare_sensors; j++) {
+            const std::string spare = "spare_sensor" + n + "_" + std::to_string(j);
+            submodels_TOP.push_back(make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>(spare.c_str(),
+                PC_9, PA_8, to_time<TIME>(1_s), config.seed + (unsigned int) (k + j * config.chains)));
+        }
+
+        if (config.cross_links && config.chains > 1) {
+            const std::string next_switch = "switch" + std::to_string(k % config.chains + 1);
+            ics_TOP.push_back(make_IC<analogInput_defs::out, switch_defs::temperature_in_2>(analog, next_switch));
+        }
+    }
+
+    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        "TOP",
+        submodels_TOP,
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::EICs{},
+        cadmium::dynamic::modeling::EOCs{},
+        ics_TOP
+    );
+}
+
+struct fan_in_config {
+    size_t sensors = 1;
+    //Sensors inside a coupled sensor_bank, reaching the switch through EOC + IC
+    bool nested = false;
+    std::string ts_input = TS_FILE;
+};
+
+struct sensor_bank_defs {
+    struct temperature_out : public out_port<float> { };
+};
+
+/*
+* Model ids: ts1, digital_temp_humidity1, analog_temp<k> for k = 1..sensors,
+* switch1, arbiter1 and lcd1 (LCD output discarded), plus sensor_bank when
+* nested. DECORATE is applied as in make_disco_top.
+*/
+template<typename TIME, template<template<typename> class> class DECORATE = undecorated>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> make_fan_in_top(const fan_in_config& config) {
+    using cadmium::dynamic::translate::make_IC;
+    using cadmium::dynamic::translate::make_EOC;
+
+    cadmium::dynamic::modeling::Models submodels_TOP;
+    cadmium::dynamic::modeling::ICs ics_TOP;
+    cadmium::dynamic::modeling::Models submodels_bank;
+    cadmium::dynamic::modeling::EOCs eocs_bank;
+
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<TouchScreen>::template model, TIME>("ts1", config.ts_input.c_str()));
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<DigitalTemperatureHumidity>::template model, TIME>("digital_temp_humidity1",
+        PC_9, PA_8, to_time<TIME>(1_s)));
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<Switch>::template model, TIME>("switch1"));
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<Arbiter>::template model, TIME>("arbiter1"));
+    submodels_TOP.push_back(make_scoped_atomic<DECORATE<LCD>::template model, TIME>("lcd1", "/dev/null"));
+
+    for (size_t k = 1; k <= config.sensors; k++) {
+        const std::string analog = "analog_temp" + std::to_string(k);
+        auto sensor = make_scoped_atomic<DECORATE<AnalogInput>::template model, TIME>(analog.c_str(), PF_6, to_time<TIME>(1_s));
+        if (config.nested) {
+            submodels_bank.push_back(sensor);
+            eocs_bank.push_back(make_EOC<analogInput_defs::out, sensor_bank_defs::temperature_out>(analog));
+        } else {
+            submodels_TOP.push_back(sensor);
+            ics_TOP.push_back(make_IC<analogInput_defs::out, switch_defs::temperature_in_2>(analog, "switch1"));
+        }
+    }
+    if (config.nested) {
+        submodels_TOP.push_back(std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+            "sensor_bank",
+            submodels_bank,
+            cadmium::dynamic::modeling::Ports{},
+            cadmium::dynamic::modeling::Ports{typeid(sensor_bank_defs::temperature_out)},
+            cadmium::dynamic::modeling::EICs{},
+            eocs_bank,
+            cadmium::dynamic::modeling::ICs{}
+        ));
+        ics_TOP.push_back(make_IC<sensor_bank_defs::temperature_out, switch_defs::temperature_in_2>("sensor_bank", "switch1"));
+    }
+
+    ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::temperature_out, switch_defs::temperature_in_1>("digital_temp_humidity1", "switch1"));
+    ics_TOP.push_back(make_IC<digitalTemperatureHumidity_defs::humidity_out, switch_defs::humidity_in_1>("digital_temp_humidity1", "switch1"));
+    ics_TOP.push_back(make_IC<TS_defs::out, switch_defs::ts_in>("ts1", "switch1"));
+    ics_TOP.push_back(make_IC<switch_defs::sensor_out, arbiter_defs::sensor_in>("switch1", "arbiter1"));
+    ics_TOP.push_back(make_IC<arbiter_defs::lcd_update_out, LCD_defs::in>("arbiter1", "lcd1"));
+
+    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        "TOP",
+        submodels_TOP,
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::EICs{},
+        cadmium::dynamic::modeling::EOCs{},
+        ics_TOP
+    );
+}
+
+#endif // RT_ARM_MBED
+
+#endif // DISCO_FLEET_TOP_HPP
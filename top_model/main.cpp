@@ -13,30 +13,216 @@
 
 #include <NDTime.hpp>
 #include <cadmium/io/iestream.hpp>
+#ifdef DISCO_FIXED_TIME
+#include "../data_structures/fixed_time.hpp"
+#endif
 
-#include "../atomics/lcd.hpp"
-#include "../atomics/digital_temp_humidity.hpp"
-#include "../atomics/arbiter.hpp"
-#include "../atomics/touch_screen.hpp"
-#include "../atomics/switch.hpp"
-
-#include <cadmium/real_time/arm_mbed/io/analogInput.hpp>
+#include "disco_top.hpp"
+#include "../engine/transition_profiler.hpp"
+#if defined(DISCO_POOLED_ALLOC) || (defined(DISCO_ALLOC_PROFILE) && !defined(RT_ARM_MBED))
+//-DDISCO_POOLED_ALLOC: bags and routing copies are recycled instead of taken from the heap
+#include "../engine/pooled_allocation.hpp"
+#endif
+#include "../engine/allocation_profiler.hpp"
+#ifdef DISCO_STATIC_TOP
+#include "static_top.hpp"
+#endif
 
 #ifdef RT_ARM_MBED
 #include "../mbed.h"
 #include <cadmium/real_time/arm_mbed/embedded_error.hpp>
+#ifdef DISCO_LATENESS
+#include "../engine/lateness_tracker.hpp"
+#endif
+#ifdef DISCO_TICKLESS
+#include "../engine/realtime_runner.hpp"
+#endif
+#ifdef DISCO_RECORDER
+#include "../loggers/flight_recorder.hpp"
+#endif
+#if defined(DISCO_REPORT_PERIOD) && !defined(DISCO_TICKLESS)
+#error "DISCO_REPORT_PERIOD needs DISCO_TICKLESS (the reports are printed by the DISCO runner)"
+#endif
 #else
-//Dummy pins for Temperature Sensors
-const char* PC_9;
-const char* PA_8;
-const char* PF_6;
+#include "batch_options.hpp"
+#include "sweep.hpp"
+#include "segments.hpp"
+#include "fleet_top.hpp"
+#include "disco_checkpoint.hpp"
+#include "disco_quiescence.hpp"
+#include "../engine/transition_counter.hpp"
+#include "../engine/chrome_trace.hpp"
+#include "../engine/realtime_runner.hpp"
+#include "../engine/flat_runner.hpp"
+#include "../engine/work_stealing_pool.hpp"
+#include "../loggers/binary_logger.hpp"
+#include "../loggers/filtered_logger.hpp"
+#include "../loggers/delta_state_logger.hpp"
+#include "../loggers/flight_recorder.hpp"
+#include "../loggers/async_sink.hpp"
 #endif
 
 using namespace std;
 
 using hclock=chrono::high_resolution_clock;
+#ifdef DISCO_FIXED_TIME
+//-DDISCO_FIXED_TIME: 64-bit microsecond time instead of NDTime
+using TIME = micro_time;
+#else
 using TIME = NDTime;
+#endif
+
+#ifdef DISCO_STATIC_TOP
+using log_formatter=cadmium::logger::formatter<TIME>;
+#else
+using log_formatter=cadmium::dynamic::logger::formatter<TIME>;
+#endif
+
+#if !defined(RT_ARM_MBED) && !defined(DISCO_STATIC_TOP)
+//--logger trace: what reaches the LCD, and the samples it is built from
+constexpr char switch1_id[] = "switch1";
+constexpr char arbiter1_id[] = "arbiter1";
+constexpr char switch_arbiter1_id[] = "switch_arbiter1";
+using disco_trace_selection=trace_selection<
+    model_ports<switch1_id, switch_defs::sensor_out>,
+    model_ports<arbiter1_id, arbiter_defs::lcd_update_out>,
+    model_ports<switch_arbiter1_id, arbiter_defs::lcd_update_out>
+>;
+#endif
+
+#if !defined(RT_ARM_MBED) || defined(DISCO_RECORDER)
+//Flight recorder trigger: an arbiter turning the LCD grey (a temperature read NaN), on the host also --trigger TEXT
+struct disco_anomaly_trigger {
+    inline static condition_edges grey;
+
+    static const char* fires(flight_event event, const std::string& model, const std::string& text) {
+        if (event == flight_event::state && text.find("LCD Colour: ") != std::string::npos) {
+            static const std::string grey_colour = "LCD Colour: " + std::to_string(LCD_COLOR_GRAY) + ",";
+            if (grey.starts(event, model, text.find(grey_colour) != std::string::npos)) return "LCD turned grey";
+        }
+        #ifndef RT_ARM_MBED
+        return text_trigger::fires(event, model, text);
+        #else
+        return nullptr;
+        #endif
+    }
+};
+#endif
+
+//Times and allocations per model, each nothing unless built with DISCO_PROFILE or DISCO_ALLOC_PROFILE
+template<template<typename> class ATOMIC>
+using profiling = typename stacked<alloc_profiled, profiled>::template decorator<ATOMIC>;
+
+#ifndef RT_ARM_MBED
+//Host runs count transitions, and trace them with --chrome-trace
+template<template<typename> class ATOMIC>
+using counting = typename stacked<counted, chrome_traced>::template decorator<ATOMIC>;
 
+template<template<typename> class ATOMIC>
+using instrumented = typename stacked<profiling, counting>::template decorator<ATOMIC>;
+
+//Every atomic can be saved and restored; checkpointed must wrap the atomic itself
+template<template<typename> class ATOMIC>
+using checkpointing = typename stacked<instrumented, checkpointed>::template decorator<ATOMIC>;
+
+//Polls of sensors no one listens to can be skipped; quiescent must wrap the atomic itself
+template<template<typename> class ATOMIC>
+using skipping = typename stacked<instrumented, quiescent>::template decorator<ATOMIC>;
+
+//The board's TOP, or with --chains a fleet of that many chains
+template<template<template<typename> class> class DECORATE>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> make_top(const disco_top_config& config, const batch_options& options) {
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> top;
+    if (options.chains == 0) {
+        top = make_disco_top<TIME, DECORATE>(config);
+    } else {
+        fleet_config fleet;
+        fleet.chains = options.chains;
+        fleet.cross_links = options.cross_links;
+        fleet.spare_sensors = options.spares;
+        fleet.ts_input = config.ts_input;
+        fleet.lcd_output_dir = options.outputs;
+        top = make_fleet_top<TIME, DECORATE>(fleet);
+    }
+    chrome_trace::connect<TIME>(top);
+    return top;
+}
+
+/*
+* Builds TOP (static with DISCO_STATIC_TOP, dynamic otherwise), runs it and
+* returns the wall time of the run. With --realtime the run is paced to the
+* wall clock and stops on a missed deadline like the board does.
+*/
+template<typename LOGGER>
+double run_top(const disco_top_config& config, const batch_options& options) {
+    const TIME horizon(options.horizon.c_str());
+
+    #ifdef DISCO_STATIC_TOP
+    static_top_config::config = config;
+    cadmium::engine::runner<TIME, disco_static_top<counted>::type, LOGGER> r({0});
+    #else
+    if (options.realtime) {
+        auto TOP = make_top<stacked<lateness_tracked, instrumented>::decorator>(config, options);
+        realtime_runner<TIME, LOGGER> r(TOP, {0}, options.speedup, MISSED_DEADLINE_TOLERANCE);
+
+        auto start = hclock::now();
+        r.run_until(horizon);
+        const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+
+        cout << "Max lateness:   " << r.max_lateness_us() << " us (" << r.late_events() << " events late, tolerance "
+             << MISSED_DEADLINE_TOLERANCE << " us)\n";
+        lateness_report::print(cout);
+        return elapsed;
+    }
+    if (!options.checkpoint_at.empty() || !options.resume.empty()) {
+        auto TOP = make_top<checkpointing>(config, options);
+        TIME start_time{0};
+        if (!options.resume.empty()) {
+            std::ifstream snapshot(options.resume, std::ios::binary);
+            start_time = restore_checkpoint(snapshot, TOP);
+        }
+        cadmium::dynamic::engine::runner<TIME, LOGGER> r(TOP, start_time);
+
+        auto start = hclock::now();
+        if (!options.checkpoint_at.empty()) {
+            const TIME checkpoint_time(options.checkpoint_at.c_str());
+            if (checkpoint_time < start_time) throw std::runtime_error("The checkpoint time is before the resumed time");
+            r.run_until(checkpoint_time);
+
+            std::ofstream snapshot(options.checkpoint, std::ios::binary);
+            save_checkpoint(snapshot, TOP, checkpoint_time);
+        }
+        r.run_until(horizon);
+        return chrono::duration<double>(hclock::now() - start).count();
+    }
+    //A logger's trace selection is applied before formatting by the flat runner only
+    if (options.flat || !std::is_void<typename trace_selection_of<LOGGER>::type>::value) {
+        auto TOP = options.skip_idle ? make_top<skipping>(config, options) : make_top<instrumented>(config, options);
+        std::unique_ptr<work_stealing_pool> pool;
+        if (options.parallel) {
+            pool.reset(new work_stealing_pool(options.parallel));
+        }
+        const idle_polls polls = options.verify_skip ? idle_polls::verify : (options.skip_idle ? idle_polls::skip : idle_polls::step);
+        flat_runner<TIME, LOGGER> r(TOP, {0}, pool.get(), polls);
+
+        auto start = hclock::now();
+        r.run_until(horizon);
+        const double elapsed = chrono::duration<double>(hclock::now() - start).count();
+        if (options.skip_idle) {
+            cout << "Skipped polls:  " << skipped_polls::count << " of " << r.quiet_pollers() << " quiet sensors"
+                 << (options.verify_skip ? ", every jump verified" : "") << "\n";
+        }
+        return elapsed;
+    }
+    auto TOP = make_top<instrumented>(config, options);
+    cadmium::dynamic::engine::runner<TIME, LOGGER> r(TOP, {0});
+    #endif
+
+    auto start = hclock::now(); //to measure simulation execution time
+    r.run_until(horizon);
+    return chrono::duration<double>(hclock::now() - start).count();
+}
+#endif
 
 int main(int argc, char ** argv) {
 
@@ -49,93 +235,296 @@ int main(int argc, char ** argv) {
     };
     #else
     // all simulation timing and I/O streams are ommited when running embedded
-    auto start = hclock::now(); //to measure simulation execution time
+    batch_options options;
+    if (!parse_batch_options(argc, argv, options)) {
+        return 1;
+    }
+    if (options.help) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    if (options.fuse && (options.sweep_runs || options.chains)) {
+        cerr << "--fuse applies to a single board TOP (sweeps monitor switch1's output)" << endl;
+        return 1;
+    }
+    if (options.spares && !options.chains) {
+        cerr << "--spares adds sensors to the chains of a fleet (--chains)" << endl;
+        return 1;
+    }
+    #ifdef DISCO_PROFILE
+    if (options.parallel || options.sweep_runs || options.segments) {
+        cerr << "The transition profile is kept for one thread: no --parallel, --sweep or --segments" << endl;
+        return 1;
+    }
+    #endif
+    #ifdef DISCO_POOLED_ALLOC
+    if (options.parallel || options.sweep_runs || options.segments) {
+        cerr << "Pooled blocks return to the free lists of the thread that frees them: no --parallel, --sweep or --segments" << endl;
+        return 1;
+    }
+    #endif
+    #ifdef DISCO_ALLOC_PROFILE
+    if (options.parallel || options.sweep_runs || options.segments || options.async) {
+        cerr << "The allocation profile is kept for one thread: no --parallel, --sweep, --segments or --async" << endl;
+        return 1;
+    }
+    #ifndef DISCO_POOLED_ALLOC
+    block_pool::enabled = false;
+    #endif
+    #endif
+    if (!options.chrome_trace.empty() && (options.parallel || options.sweep_runs || options.segments || !options.resume.empty())) {
+        cerr << "--chrome-trace follows one run from time zero on one thread: no --parallel, --sweep, --segments or --resume" << endl;
+        return 1;
+    }
+    if (options.parallel && options.sweep_runs) {
+        cerr << "--parallel runs one TOP on several threads; sweeps already run one TOP per thread (--threads)" << endl;
+        return 1;
+    }
+    if (options.sweep_runs) {
+        try {
+            return run_sweep_mode<TIME>(options);
+        } catch (const std::exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    if (options.segments) {
+        #ifdef DISCO_STATIC_TOP
+        cerr << "Time-parallel runs need the dynamic engine" << endl;
+        return 1;
+        #else
+        if (options.realtime || options.flat || options.chains || options.async || !options.checkpoint_at.empty() || !options.resume.empty()) {
+            cerr << "--segments runs the board's TOP on cadmium's runner: no real-time, flat, fleet, async or checkpoint options" << endl;
+            return 1;
+        }
+        disco_top_config config;
+        config.ts_input = options.inputs + "/TS_in.txt";
+        config.lcd_output = options.outputs + "/LCD_out.txt";
+        config.fuse_switch_arbiter = options.fuse;
+
+        //A restored segment logs what the sequential run logs only for messages and global time
+        using segment_messages=cadmium::logger::logger<cadmium::logger::logger_messages, log_formatter, segment_sink_provider>;
+        using segment_global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, log_formatter, segment_sink_provider>;
+        try {
+            switch (options.logger) {
+                case logger_selection::none: return run_segmented_mode<TIME, cadmium::logger::not_logger>(config, options);
+                case logger_selection::top: return run_segmented_mode<TIME, cadmium::logger::multilogger<segment_messages, segment_global_time>>(config, options);
+                default:
+                    cerr << "--segments supports the none and top loggers" << endl;
+                    return 1;
+            }
+        } catch (const std::exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        #endif
+    }
+
+    static std::ofstream out_data(options.log_file, std::ios::binary);
+    static std::ostream* out = &out_data;
+
+    //With --async only the writer thread touches out_data
+    std::unique_ptr<async_log_stream> async_out;
+    if (options.async) {
+        async_out.reset(new async_log_stream(out_data));
+        out = async_out.get();
+    }
 
-    static std::ofstream out_data("disco_output.txt");
     struct oss_sink_provider{
         static std::ostream& sink(){
-            return out_data;
+            return *out;
         }
     };
     #endif
 
     /*************** Loggers *******************/
-    using info=cadmium::logger::logger<cadmium::logger::logger_info, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using debug=cadmium::logger::logger<cadmium::logger::logger_debug, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using state=cadmium::logger::logger<cadmium::logger::logger_state, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using routing=cadmium::logger::logger<cadmium::logger::logger_message_routing, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
-    using local_time=cadmium::logger::logger<cadmium::logger::logger_local_time, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
+    using info=cadmium::logger::logger<cadmium::logger::logger_info, log_formatter, oss_sink_provider>;
+    using debug=cadmium::logger::logger<cadmium::logger::logger_debug, log_formatter, oss_sink_provider>;
+    using state=cadmium::logger::logger<cadmium::logger::logger_state, log_formatter, oss_sink_provider>;
+    using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, log_formatter, oss_sink_provider>;
+    using routing=cadmium::logger::logger<cadmium::logger::logger_message_routing, log_formatter, oss_sink_provider>;
+    using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, log_formatter, oss_sink_provider>;
+    using local_time=cadmium::logger::logger<cadmium::logger::logger_local_time, log_formatter, oss_sink_provider>;
     using log_all=cadmium::logger::multilogger<info, debug, state, log_messages, routing, global_time, local_time>;
 
     using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
 
-    /*******************************************/
-    using AtomicModelPtr=std::shared_ptr<cadmium::dynamic::modeling::model>;
-    using CoupledModelPtr=std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>;
-
-    /********************************************/
-    /******* Temperature Sensors *********/
-    /********************************************/
-    AtomicModelPtr digital_temp_humidity1 = cadmium::dynamic::translate::make_dynamic_atomic_model<DigitalTemperatureHumidity, TIME>("digital_temp_humidity1", PC_9, PA_8);
-    AtomicModelPtr analog_temp1 = cadmium::dynamic::translate::make_dynamic_atomic_model<AnalogInput, TIME>("analog_temp1", PF_6, TIME("00:00:01:000"));
-
-    /********************************************/
-    /**************** LCD ***********************/
-    /********************************************/
-    AtomicModelPtr lcd1 = cadmium::dynamic::translate::make_dynamic_atomic_model<LCD, TIME>("lcd1");
+    #if !defined(RT_ARM_MBED) && !defined(DISCO_STATIC_TOP)
+    //Same events as logger_top, decoded to text with TRACE_DECODER
+    using binary_messages=binary_logger<cadmium::logger::logger_messages, oss_sink_provider>;
+    using binary_global_time=binary_logger<cadmium::logger::logger_global_time, oss_sink_provider>;
+    using binary_top=cadmium::logger::multilogger<binary_messages, binary_global_time>;
 
-    /********************************************/
-    /************ Touch Screen ******************/
-    /********************************************/
-    AtomicModelPtr ts1 = cadmium::dynamic::translate::make_dynamic_atomic_model<TouchScreen, TIME>("ts1");
+    using logger_trace=filtered_logger<disco_trace_selection, logger_top>;
 
-    /********************************************/
-    /**************** Arbiter *******************/
-    /********************************************/
-    AtomicModelPtr arbiter1 = cadmium::dynamic::translate::make_dynamic_atomic_model<Arbiter, TIME>("arbiter1");
-
-    /********************************************/
-    /**************** Switch *******************/
-    /********************************************/
-    AtomicModelPtr switch1 = cadmium::dynamic::translate::make_dynamic_atomic_model<Switch, TIME>("switch1");
+    //Windows of messages, global time and states around each trigger
+    using recorded_events=cadmium::logger::multilogger<log_messages, global_time, state>;
+    using logger_recorder=flight_recorder<TIME, disco_anomaly_trigger, replayed_window<TIME, recorded_events, oss_sink_provider>>;
+    #endif
+    #ifndef RT_ARM_MBED
+    using state_deltas=delta_state_logger<TIME, state>;
+    using logger_delta=cadmium::logger::multilogger<log_messages, global_time, state_deltas>;
+    #endif
 
     /************************/
     /*******TOP MODEL********/
     /************************/
-    cadmium::dynamic::modeling::Ports iports_TOP = {};
-    cadmium::dynamic::modeling::Ports oports_TOP = {};
-    cadmium::dynamic::modeling::Models submodels_TOP =  {digital_temp_humidity1, analog_temp1, arbiter1, lcd1, ts1, switch1};
-    cadmium::dynamic::modeling::EICs eics_TOP = {};
-    cadmium::dynamic::modeling::EOCs eocs_TOP = {};
-    cadmium::dynamic::modeling::ICs ics_TOP = {
-        cadmium::dynamic::translate::make_IC<digitalTemperatureHumidity_defs::temperature_out, switch_defs::temperature_in_1>("digital_temp_humidity1","switch1"),
-        cadmium::dynamic::translate::make_IC<digitalTemperatureHumidity_defs::humidity_out, switch_defs::humidity_in_1>("digital_temp_humidity1","switch1"),
-        cadmium::dynamic::translate::make_IC<analogInput_defs::out, switch_defs::temperature_in_2>("analog_temp1","switch1"),
-
-        cadmium::dynamic::translate::make_IC<TS_defs::out, switch_defs::ts_in>("ts1", "switch1"),
-        cadmium::dynamic::translate::make_IC<switch_defs::sensor_out, arbiter_defs::sensor_in>("switch1", "arbiter1"),
-        cadmium::dynamic::translate::make_IC<arbiter_defs::lcd_update_out, LCD_defs::in>("arbiter1","lcd1"),
-    };
-    CoupledModelPtr TOP = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
-        "TOP",
-        submodels_TOP,
-        iports_TOP,
-        oports_TOP,
-        eics_TOP,
-        eocs_TOP,
-        ics_TOP
-    );
-
     ///****************////
     #ifdef RT_ARM_MBED
+    /*
+    * -DDISCO_LATENESS collects lateness histograms (lateness_report), -DDISCO_PROFILE the transition
+    * profile (profile_report), -DDISCO_ALLOC_PROFILE the heap use per model and message type
+    * (allocation_report). Read them with the debugger, or with DISCO_TICKLESS print them every
+    * DISCO_REPORT_PERIOD seconds on boards with a working serial port.
+    */
+    disco_top_config config;
+    #ifdef DISCO_RECORDER
+    /*
+    * -DDISCO_RECORDER: the last events are kept in SDRAM, and the window around the LCD turning grey, or
+    * (with DISCO_TICKLESS) a missed deadline, is left at DISCO_RECORDER_WINDOW for the debugger
+    */
+    using disco_logger=flight_recorder<TIME, disco_anomaly_trigger, sdram_window>;
+    #else
+    using disco_logger=cadmium::logger::not_logger;
+    #endif
+    #ifdef DISCO_FUSE
+    //-DDISCO_FUSE: switch1 -> arbiter1 as one atomic, one engine round less per sample
+    config.fuse_switch_arbiter = true;
+    #endif
+    #ifdef DISCO_LATENESS
+    auto TOP = make_disco_top<TIME, stacked<lateness_tracked, profiling>::decorator>(config);
+    #else
+    auto TOP = make_disco_top<TIME, profiling>(config);
+    #endif
     //Logging not possible on DISCO: UART over SWD USB not supported
-    cadmium::dynamic::engine::runner<NDTime, cadmium::logger::not_logger> r(TOP, {0});
+    #ifdef DISCO_TICKLESS
+    //Sleeps on a low-power timer until each event instead of cadmium's runner
+    realtime_runner<TIME, disco_logger> r(TOP, {0}, 1.0, MISSED_DEADLINE_TOLERANCE);
+    #ifdef DISCO_REPORT_PERIOD
+    //This build has no RTOS threads: the reports are printed between slices of the run
+    const TIME period = time_conversion<TIME>::from_nanoseconds(DISCO_REPORT_PERIOD * 1000000000LL);
+    #if MBED_HEAP_STATS_ENABLED
+    uint32_t reported_allocations = 0;
+    #endif
+    for (TIME report = period; ; report = report + period) {
+        r.run_until(report);
+        cout << "Wake lateness: p50 " << r.wake_lateness().percentile(0.5) << " us, p99 " << r.wake_lateness().percentile(0.99)
+             << " us, max " << r.wake_lateness().max() << " us (tolerance " << MISSED_DEADLINE_TOLERANCE << " us)\n";
+        #if MBED_HEAP_STATS_ENABLED
+        //Counted by mbed's wrapped _malloc_r: 0 allocations per period once a DISCO_POOLED_ALLOC build is warm
+        mbed_stats_heap_t heap;
+        mbed_stats_heap_get(&heap);
+        cout << "Heap: " << heap.alloc_cnt - reported_allocations << " allocations since the last report, "
+             << heap.current_size << " bytes in use\n";
+        reported_allocations = heap.alloc_cnt;
+        #endif
+        #ifdef DISCO_LATENESS
+        lateness_report::print(cout);
+        #endif
+        profile_report::print(cout);
+        allocation_report::print(cout, time_conversion<TIME>::to_nanoseconds(report) / 1e9);
+    }
+    #else
     r.run_until(TIME::infinity());
+    #endif
+    #else
+    #ifdef DISCO_LATENESS
+    lateness_clock::start();
+    #endif
+    cadmium::dynamic::engine::runner<TIME, disco_logger> r(TOP, {0});
+    r.run_until(TIME::infinity());
+    #endif
     #else
-    cadmium::dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});
-    r.run_until(TIME("00:01:00:000"));
+    disco_top_config config;
+    config.ts_input = options.inputs + "/TS_in.txt";
+    config.lcd_output = options.outputs + "/LCD_out.txt";
+    config.fuse_switch_arbiter = options.fuse;
+
+    #ifdef DISCO_STATIC_TOP
+    if (options.realtime || options.chains || options.flat || options.fuse || !options.checkpoint_at.empty() || !options.resume.empty()
+        || !options.chrome_trace.empty()) {
+        cerr << "Real-time, fleet, flat, fused, checkpoint and Chrome trace modes need the dynamic engine" << endl;
+        return 1;
+    }
+    #endif
+    if (options.realtime && (!options.checkpoint_at.empty() || !options.resume.empty())) {
+        cerr << "Checkpoints are not supported in real-time mode" << endl;
+        return 1;
+    }
+    if (options.flat && (options.realtime || !options.checkpoint_at.empty() || !options.resume.empty())) {
+        cerr << "The flat runner does not pace or checkpoint runs" << endl;
+        return 1;
+    }
+
+    //Opened before TOP is built: only atomics built while it is open are traced
+    std::ofstream chrome_trace_out;
+    if (!options.chrome_trace.empty()) {
+        chrome_trace_out.open(options.chrome_trace, std::ios::binary);
+        chrome_trace::open(chrome_trace_out);
+    }
+    const double horizon_us = chrome_trace::simulated_us(TIME(options.horizon.c_str()));
+
+    double elapsed = 0;
+    try {
+        switch (options.logger) {
+            case logger_selection::none: elapsed = run_top<cadmium::logger::not_logger>(config, options); break;
+            case logger_selection::top:  elapsed = run_top<logger_top>(config, options); break;
+            case logger_selection::all:  elapsed = run_top<log_all>(config, options); break;
+            case logger_selection::delta:
+                state_deltas::keyframe_period = TIME(options.keyframe.c_str());
+                elapsed = run_top<logger_delta>(config, options);
+                break;
+            #ifdef DISCO_STATIC_TOP
+            case logger_selection::binary:
+            case logger_selection::trace:
+            case logger_selection::recorder:
+                cerr << "The binary, trace and recorder loggers need the dynamic engine" << endl;
+                return 1;
+            #else
+            case logger_selection::binary: elapsed = run_top<binary_top>(config, options); break;
+            case logger_selection::trace: elapsed = run_top<logger_trace>(config, options); break;
+            case logger_selection::recorder:
+                logger_recorder::configure(options.before, options.after);
+                text_trigger::text = options.trigger;
+                elapsed = run_top<logger_recorder>(config, options);
+                logger_recorder::finish();
+                cout << "Flight recorder: " << logger_recorder::windows() << " windows written, "
+                     << logger_recorder::recorded() << " events recorded\n";
+                break;
+            #endif
+        }
+    } catch (const std::runtime_error& e) {
+        //The log up to the error (e.g. a missed deadline) is kept
+        #ifndef DISCO_STATIC_TOP
+        if (options.logger == logger_selection::recorder) {
+            logger_recorder::finish();
+        }
+        #endif
+        if (async_out) {
+            async_out->close();
+        }
+        out_data.flush();
+        chrome_trace::finish(chrome_trace::latest());
+        cerr << e.what() << endl;
+        if (options.realtime) {
+            lateness_report::print(cerr);
+        }
+        return 1;
+    }
+    if (async_out) {
+        async_out->close();
+    }
+    out_data.flush();
+
+    print_throughput_report(cout, TIME(options.horizon.c_str()), elapsed, transition_counter::total());
+    if (!options.chrome_trace.empty()) {
+        cout << "Chrome trace:   " << chrome_trace::finish(horizon_us) << " events written to " << options.chrome_trace << "\n";
+    }
+    #ifdef DISCO_POOLED_ALLOC
+    cout << "Allocations:    " << block_pool::allocations << " (" << block_pool::heap_allocations << " from malloc)\n";
+    #endif
+    profile_report::print(cout);
+    allocation_report::print(cout, time_conversion<TIME>::to_nanoseconds(TIME(options.horizon.c_str())) / 1e9);
     return 0;
     #endif
 }
@@ -0,0 +1,146 @@
+/**
+* ARSLab - Carleton University
+*
+* Time-parallel mode of DISCO_TOP:
+* Cuts the horizon into S segments and runs them on separate threads with
+* run_time_parallel (engine/time_parallel.hpp). The state each segment
+* starts from is guessed by a quick run of TOP on flat_runner without the
+* sensors' samples: the sensors are still stepped, so they reach the
+* boundary exact, and the touch events still reach the switch, so it
+* holds the sensor they select, but nothing else passes through the
+* switch, arbiter and LCD. They only keep the latest samples, so the last
+* few polls before each boundary are run on the whole TOP, restored from
+* that guess, to bring them in; a wrong guess is run again by
+* run_time_parallel from the end of the segment before. Each
+* segment logs to <log>.seg<k> and writes <outputs>/LCD_out.txt.seg<k>;
+* once every segment is accepted they are joined into the usual files,
+* which then hold what a sequential run writes.
+*
+* Only the loggers whose output a restored run reproduces exactly are
+* supported: none and top (messages and global time).
+*/
+
+#ifndef DISCO_SEGMENTS_HPP
+#define DISCO_SEGMENTS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "disco_top.hpp"
+#include "batch_options.hpp"
+#include "disco_checkpoint.hpp"
+#include "../engine/flat_runner.hpp"
+#include "../engine/time_parallel.hpp"
+#include "../engine/transition_counter.hpp"
+
+//Guessed snapshots of TOP at each boundary (the first, the start, is left empty)
+template<typename TIME>
+std::vector<std::string> predict_segment_starts(disco_top_config config, const std::vector<TIME>& boundaries) {
+    const TIME lead_in = to_time<TIME>(3_s);
+    config.lcd_output = "/dev/null";
+    auto TOP = make_disco_top<TIME, checkpointed>(config);
+    auto& ics = TOP->_ic;
+    ics.erase(std::remove_if(ics.begin(), ics.end(), [](const cadmium::dynamic::modeling::IC& ic) {
+        return ic._from == "digital_temp_humidity1" || ic._from == "analog_temp1";
+    }), ics.end());
+    flat_runner<TIME, cadmium::logger::not_logger> r(TOP, boundaries.front());
+
+    std::vector<std::string> starts(boundaries.size() - 1);
+    for (size_t k = 1; k < starts.size(); k++) {
+        const TIME from = boundaries[k] - boundaries[k - 1] < lead_in ? boundaries[k - 1] : boundaries[k] - lead_in;
+        r.run_until(from);
+        std::ostringstream sensors_only;
+        save_checkpoint(sensors_only, TOP, from);
+
+        auto lead_TOP = make_disco_top<TIME, checkpointed>(config);
+        std::istringstream in(sensors_only.str());
+        restore_checkpoint(in, lead_TOP);
+        flat_runner<TIME, cadmium::logger::not_logger> lead(lead_TOP, from);
+        lead.run_until(boundaries[k]);
+        std::ostringstream snapshot;
+        save_checkpoint(snapshot, lead_TOP, boundaries[k]);
+        starts[k] = snapshot.str();
+    }
+    return starts;
+}
+
+//Appends each part to path and removes it
+inline void join_segment_files(const std::string& path, size_t segments) {
+    std::ofstream joined(path, std::ios::binary);
+    for (size_t k = 0; k < segments; k++) {
+        const std::string part = path + ".seg" + std::to_string(k);
+        {
+            std::ifstream in(part, std::ios::binary);
+            joined << in.rdbuf();
+        }
+        std::remove(part.c_str());
+    }
+    if (!joined) throw std::runtime_error("Could not write " + path);
+}
+
+/*
+* Runs TOP from the predicted segment starts until every segment is
+* accepted, and joins the segments' LCD outputs and logs (LOGGER logs
+* through segment_sink_provider) into config.lcd_output and log_file.
+*/
+template<typename TIME, typename LOGGER>
+time_parallel_report run_segments(const disco_top_config& config, const std::string& log_file, const std::vector<TIME>& boundaries,
+                                  const std::vector<std::string>& predicted, unsigned int threads) {
+    const time_parallel_report report = run_time_parallel(boundaries, predicted, threads,
+                                                          [&](size_t k, const std::string& snapshot, const TIME& from, const TIME& until) {
+        disco_top_config segment_config = config;
+        segment_config.lcd_output = config.lcd_output + ".seg" + std::to_string(k);
+        std::ofstream log(log_file + ".seg" + std::to_string(k), std::ios::binary);
+        segment_sink_provider::stream = &log;
+
+        transition_counter::reset();
+        auto TOP = make_disco_top<TIME, stacked<counted, checkpointed>::decorator>(segment_config);
+        if (k > 0) {
+            std::istringstream in(snapshot);
+            restore_checkpoint(in, TOP);
+        }
+        cadmium::dynamic::engine::runner<TIME, LOGGER> r(TOP, from);
+        r.run_until(until);
+
+        segment_result result;
+        std::ostringstream end;
+        save_checkpoint(end, TOP, until);
+        result.end = end.str();
+        result.transitions = transition_counter::total();
+        return result;
+    });
+    join_segment_files(config.lcd_output, report.segments);
+    join_segment_files(log_file, report.segments);
+    return report;
+}
+
+template<typename TIME, typename LOGGER>
+int run_segmented_mode(const disco_top_config& config, const batch_options& options) {
+    using hclock=std::chrono::high_resolution_clock;
+    const TIME horizon(options.horizon.c_str());
+    const std::vector<TIME> boundaries = segment_boundaries(TIME{0}, horizon, options.segments);
+
+    auto start = hclock::now();
+    const std::vector<std::string> predicted = predict_segment_starts(config, boundaries);
+    const double prediction = std::chrono::duration<double>(hclock::now() - start).count();
+
+    const time_parallel_report report = run_segments<TIME, LOGGER>(config, options.log_file, boundaries, predicted, options.threads);
+    const double elapsed = std::chrono::duration<double>(hclock::now() - start).count();
+
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    std::cout << "Segments:       " << report.segments << " (" << report.rounds << " rounds, "
+              << report.runs - report.segments << " segments run again)\n"
+              << "Prediction:     " << std::fixed << std::setprecision(3) << prediction << " s\n";
+    std::cout.flags(flags);
+    print_throughput_report(std::cout, horizon, elapsed, report.transitions);
+    return 0;
+}
+
+#endif // DISCO_SEGMENTS_HPP
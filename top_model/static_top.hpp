@@ -0,0 +1,93 @@
+/**
+* ARSLab - Carleton University
+*
+* Static DISCO TOP model:
+* The same coupling as make_disco_top (disco_top.hpp), built with cadmium's
+* tuple-based coupled_model so the engine routes messages without type
+* erasure. Build DISCO_TOP with -DDISCO_STATIC_TOP (make static) to use it.
+*
+* The static engine default-constructs every atomic, so the models that
+* need pins or files are wrapped below and read their settings from
+* static_top_config::config.
+*/
+
+#ifndef DISCO_STATIC_TOP_HPP
+#define DISCO_STATIC_TOP_HPP
+
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+
+#include "disco_top.hpp"
+
+//Settings for the default-constructed atomics; set before building a runner
+struct static_top_config {
+    inline static disco_top_config config;
+};
+
+template<typename TIME>
+class StaticDigitalTemperatureHumidity : public DigitalTemperatureHumidity<TIME> {
+public:
+    #ifdef RT_ARM_MBED
+    StaticDigitalTemperatureHumidity() : DigitalTemperatureHumidity<TIME>(PC_9, PA_8) {}
+    #else
+    StaticDigitalTemperatureHumidity() : DigitalTemperatureHumidity<TIME>(PC_9, PA_8, to_time<TIME>(1_s),
+        static_top_config::config.seeded ? static_top_config::config.seed : std::default_random_engine::default_seed) {}
+    #endif
+};
+
+template<typename TIME>
+class StaticAnalogInput : public AnalogInput<TIME> {
+public:
+    StaticAnalogInput() : AnalogInput<TIME>(PF_6, to_time<TIME>(1_s)) {}
+};
+
+#ifndef RT_ARM_MBED
+template<typename TIME>
+class StaticTouchScreen : public TouchScreen<TIME> {
+public:
+    StaticTouchScreen() : TouchScreen<TIME>(static_top_config::config.ts_input.c_str()) {}
+};
+
+template<typename TIME>
+class StaticLCD : public LCD<TIME> {
+public:
+    StaticLCD() : LCD<TIME>(static_top_config::config.lcd_output.c_str()) {}
+};
+#else
+template<typename TIME> using StaticTouchScreen = TouchScreen<TIME>;
+template<typename TIME> using StaticLCD = LCD<TIME>;
+#endif
+
+/*
+* disco_static_top<DECORATE>::type<TIME> is the coupled model; DECORATE
+* wraps every atomic as in make_disco_top.
+*/
+template<template<template<typename> class> class DECORATE = undecorated>
+struct disco_static_top {
+    template<typename TIME> using digital_temp_humidity = typename DECORATE<StaticDigitalTemperatureHumidity>::template model<TIME>;
+    template<typename TIME> using analog_temp = typename DECORATE<StaticAnalogInput>::template model<TIME>;
+    template<typename TIME> using lcd = typename DECORATE<StaticLCD>::template model<TIME>;
+    template<typename TIME> using ts = typename DECORATE<StaticTouchScreen>::template model<TIME>;
+    template<typename TIME> using arbiter = typename DECORATE<Arbiter>::template model<TIME>;
+    template<typename TIME> using sensor_switch = typename DECORATE<Switch>::template model<TIME>;
+
+    using iports=std::tuple<>;
+    using oports=std::tuple<>;
+    using submodels=cadmium::modeling::models_tuple<digital_temp_humidity, analog_temp, arbiter, lcd, ts, sensor_switch>;
+    using eics=std::tuple<>;
+    using eocs=std::tuple<>;
+    using ics=std::tuple<
+        cadmium::modeling::IC<digital_temp_humidity, digitalTemperatureHumidity_defs::temperature_out, sensor_switch, switch_defs::temperature_in_1>,
+        cadmium::modeling::IC<digital_temp_humidity, digitalTemperatureHumidity_defs::humidity_out, sensor_switch, switch_defs::humidity_in_1>,
+        cadmium::modeling::IC<analog_temp, analogInput_defs::out, sensor_switch, switch_defs::temperature_in_2>,
+
+        cadmium::modeling::IC<ts, TS_defs::out, sensor_switch, switch_defs::ts_in>,
+        cadmium::modeling::IC<sensor_switch, switch_defs::sensor_out, arbiter, arbiter_defs::sensor_in>,
+        cadmium::modeling::IC<arbiter, arbiter_defs::lcd_update_out, lcd, LCD_defs::in>
+    >;
+
+    template<typename TIME>
+    using type=cadmium::modeling::pdevs::coupled_model<TIME, iports, oports, submodels, eics, eocs, ics>;
+};
+
+#endif // DISCO_STATIC_TOP_HPP
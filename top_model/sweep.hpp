@@ -0,0 +1,104 @@
+/**
+* ARSLab - Carleton University
+*
+* Monte Carlo sweep mode of DISCO_TOP:
+* Runs N copies of TOP, each with its own sensor seed, in parallel and
+* reports the merged LCD colour distribution, update counts and NaN rates.
+*/
+
+#ifndef DISCO_SWEEP_HPP
+#define DISCO_SWEEP_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "disco_top.hpp"
+#include "batch_options.hpp"
+#include "../engine/sweep_runner.hpp"
+#include "../engine/transition_counter.hpp"
+
+struct sweep_run_result {
+    monitor_stats stats;
+    unsigned long long transitions = 0;
+};
+
+inline const char* lcd_colour_name(uint32_t colour) {
+    switch (colour) {
+        case LCD_COLOR_DARKBLUE:  return "DARKBLUE";
+        case LCD_COLOR_LIGHTBLUE: return "LIGHTBLUE";
+        case LCD_COLOR_GREEN:     return "GREEN";
+        case LCD_COLOR_ORANGE:    return "ORANGE";
+        case LCD_COLOR_DARKRED:   return "DARKRED";
+        case LCD_COLOR_GRAY:      return "GRAY";
+        default:                  return "OTHER";
+    }
+}
+
+inline void print_sweep_report(std::ostream& os, const monitor_stats& total, size_t runs) {
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed;
+
+    os << "LCD updates:    " << total.lcd_updates << " (" << std::setprecision(1)
+       << (runs ? (double) total.lcd_updates / runs : 0.0) << " per run)\n";
+
+    os << "LCD colour distribution:\n";
+    for (const auto& colour : total.lcd_colours) {
+        os << "  " << std::left << std::setw(10) << lcd_colour_name(colour.first) << std::right
+           << std::setw(14) << colour.second
+           << std::setw(9) << std::setprecision(2) << 100.0 * colour.second / total.lcd_updates << " %\n";
+    }
+
+    os << "Displayed samples (NaN temperature / NaN humidity):\n";
+    for (const auto& sensor : total.sensors) {
+        const double samples = (double) sensor.second.samples;
+        os << "  " << std::left << std::setw(10) << sensor.first << std::right
+           << std::setw(14) << sensor.second.samples
+           << std::setw(9) << std::setprecision(2) << 100.0 * sensor.second.nan_temperature / samples << " %"
+           << std::setw(9) << 100.0 * sensor.second.nan_humidity / samples << " %\n";
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+template<typename TIME>
+int run_sweep_mode(const batch_options& options) {
+    using hclock=std::chrono::high_resolution_clock;
+    const TIME horizon(options.horizon.c_str());
+
+    auto start = hclock::now();
+
+    auto results = run_sweep<sweep_run_result>(options.sweep_runs, options.threads, [&](size_t run, sweep_run_result& result) {
+        disco_top_config config;
+        config.ts_input = options.inputs + "/TS_in.txt";
+        config.lcd_output = "/dev/null"; //runs would otherwise share one file
+        config.seeded = true;
+        config.seed = options.seed + (unsigned int) run;
+        config.monitor = &result.stats;
+
+        transition_counter::reset();
+        auto TOP = make_disco_top<TIME, counted>(config);
+        cadmium::dynamic::engine::runner<TIME, cadmium::logger::not_logger> r(TOP, {0});
+        r.run_until(horizon);
+        result.transitions = transition_counter::total();
+    });
+
+    monitor_stats total;
+    unsigned long long transitions = 0;
+    for (const auto& result : results) {
+        total += result.stats;
+        transitions += result.transitions;
+    }
+    const double elapsed = std::chrono::duration<double>(hclock::now() - start).count();
+
+    std::cout << "Sweep runs:     " << options.sweep_runs << " (seeds " << options.seed << " to "
+              << options.seed + options.sweep_runs - 1 << ")\n";
+    print_sweep_report(std::cout, total, options.sweep_runs);
+    print_throughput_report(std::cout, horizon, elapsed, transitions);
+    return 0;
+}
+
+#endif // DISCO_SWEEP_HPP